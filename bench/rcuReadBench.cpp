@@ -0,0 +1,70 @@
+// Read scaling of RcuUnorderedMap against ConcurrentUnorderedMap on a
+// read-mostly workload: every thread looks up random keys and, by default,
+// one lookup in a thousand is replaced by an update.
+//
+// Built as the rcu_read_bench target of bench/CMakeLists.txt:
+//   ./rcu_read_bench [max_threads=64] [keys=100000] [ops_per_thread=2000000]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "concurrentUnorderedMapHeader.hpp"
+#include "rcuUnorderedMapHeader.hpp"
+
+namespace {
+
+constexpr unsigned WRITE_EVERY = 1000;
+
+template<class Map, class Update>
+double run(Map& map, unsigned threads, size_t keys, size_t ops, Update update) {
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&map, &update, t, keys, ops] {
+            std::mt19937_64 rng(t + 1);
+            size_t found = 0;
+            for (size_t i = 0; i < ops; ++i) {
+                size_t key = rng() % keys;
+                if (i % WRITE_EVERY == WRITE_EVERY - 1) {
+                    update(map, key);
+                } else {
+                    found += map.contains(key);
+                }
+            }
+            if (found == size_t(-1)) std::puts("");
+        });
+    }
+    for (std::thread& w : workers) w.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return double(threads) * double(ops) / elapsed.count() / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    unsigned max_threads = argc > 1 ? unsigned(std::atoi(argv[1])) : 64;
+    size_t keys = argc > 2 ? size_t(std::atoll(argv[2])) : 100000;
+    size_t ops = argc > 3 ? size_t(std::atoll(argv[3])) : 2000000;
+
+    // Many small shards keep the copy an RCU write makes cheap.
+    RcuUnorderedMap<size_t, size_t> rcu(1024);
+    ConcurrentUnorderedMap<size_t, size_t> locked(1024);
+    for (size_t k = 0; k < keys; ++k) {
+        rcu.insert({ k, k });
+        locked.insert({ k, k });
+    }
+
+    std::printf("%8s %12s %20s\n", "threads", "rcu Mops/s", "shared_mutex Mops/s");
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        double r = run(rcu, threads, keys, ops,
+                       [](auto& m, size_t k) { m.update(k, [](auto& kv) { ++kv.second; }); });
+        double l = run(locked, threads, keys, ops,
+                       [](auto& m, size_t k) { m.visit(k, [](auto& kv) { ++kv.second; }); });
+        std::printf("%8u %12.1f %20.1f\n", threads, r, l);
+    }
+    return 0;
+}
@@ -0,0 +1,386 @@
+// Benchmarks UnorderedMap against std::unordered_map, absl::flat_hash_map
+// and boost::unordered_flat_map. Every operation runs over int, 16-byte and
+// 64-byte string keys at sizes from 1K to UNORDERED_MAP_BENCH_MAX_SIZE, and
+// over raw sequential and strided integers, which std::hash passes through
+// unchanged.
+// Benchmark names read operation/map/key/size, so one comparison can be
+// picked out with e.g. --benchmark_filter='find_hit/.*/int/1000000$'.
+// A second set compares element layouts with 256-byte mapped values: the
+// std::pair nodes and slots of UnorderedMap against the separate key and
+// value arrays of SplitUnorderedMap. Its key names end in .v256. A third
+// set inserts keys built to collide into maps using SeededHash, which
+// must stay as fast as with ordinary keys.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "splitUnorderedMapHeader.hpp"
+#include "unorderedMapHeader.hpp"
+
+#if defined(UNORDERED_MAP_BENCH_ABSL)
+#include <absl/container/flat_hash_map.h>
+#endif
+#if defined(UNORDERED_MAP_BENCH_BOOST)
+#include <boost/unordered/unordered_flat_map.hpp>
+#endif
+
+#ifndef UNORDERED_MAP_BENCH_MAX_SIZE
+#define UNORDERED_MAP_BENCH_MAX_SIZE 100000000
+#endif
+
+// The layout benchmarks stop at a million elements: 256 MB of values.
+constexpr int64_t LAYOUT_MAX_SIZE = UNORDERED_MAP_BENCH_MAX_SIZE < 1000000 ? UNORDERED_MAP_BENCH_MAX_SIZE : 1000000;
+
+namespace {
+
+uint64_t mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    return x ^ (x >> 33);
+}
+
+// Key generators: make(i) is distinct for every i. IntKey and StringKey
+// spread consecutive indices over the whole key space.
+struct IntKey {
+    using type = uint64_t;
+    static constexpr const char* name = "int";
+    static type make(uint64_t i) { return mix(i); }
+};
+
+// Integers as programs insert them: 0, 1, 2, ... and multiples of 16,
+// the spacing of heap pointers. An identity hash leaves these clustered,
+// so they catch tables that rely on the hash alone to spread keys.
+struct SequentialIntKey {
+    using type = uint64_t;
+    static constexpr const char* name = "int.seq";
+    static type make(uint64_t i) { return i; }
+};
+
+struct StridedIntKey {
+    using type = uint64_t;
+    static constexpr const char* name = "int.stride16";
+    static type make(uint64_t i) { return i * 16; }
+};
+
+template<size_t Length>
+struct StringKey {
+    using type = std::string;
+    static constexpr const char* name = Length == 16 ? "str16" : "str64";
+    static type make(uint64_t i) {
+        static const char digits[] = "0123456789abcdef";
+        std::string s(Length, '0');
+        uint64_t h = mix(i);
+        // The index itself goes last, so keys stay unique for any length.
+        for (size_t c = 0; c < Length; ++c) {
+            uint64_t v = c >= Length - 16 ? i >> (4 * (Length - 1 - c)) : h >> (4 * (c % 16));
+            s[c] = digits[v & 15];
+        }
+        return s;
+    }
+};
+
+// 40-byte strings that differ only in bytes 0-15. Bytes 16-23 hold the
+// constant SeededHash's string hash once XORed into the first factor of
+// its second product, which zeroed that product and with it the seed:
+// every one of these keys hashed alike under any seed.
+struct FloodKey {
+    using type = std::string;
+    static constexpr const char* name = "str40.flood";
+    static type make(uint64_t i) {
+        const uint64_t words[3] = { mix(i), i, 0xE7037ED1A0B428DBull };
+        std::string s(40, '0');
+        std::memcpy(&s[0], words, sizeof(words));
+        return s;
+    }
+};
+
+// Mapped value that fills four cache lines, so that storing it next to
+// its key costs every probed element's value a cache miss.
+struct Payload {
+    Payload(uint64_t v = 0) : words{ v } {}
+
+    uint64_t words[32];
+};
+
+uint64_t key_bit(uint64_t key) { return key & 1; }
+uint64_t key_bit(const std::string& key) { return key.back() & 1; }
+
+// Visits every key: through the iterators for maps that keep std::pair
+// elements, through the dense key array for SplitUnorderedMap.
+template<class Map, class F>
+void for_each_key(const Map& m, F&& f) {
+    for (const auto& kv : m) f(kv.first);
+}
+
+template<class K, class V, class... Rest, class F>
+void for_each_key(const SplitUnorderedMap<K, V, Rest...>& m, F&& f) {
+    for (const K& key : m.keys()) f(key);
+}
+
+template<class KeyGen>
+std::vector<typename KeyGen::type> make_keys(size_t n, uint64_t offset) {
+    std::vector<typename KeyGen::type> keys;
+    keys.reserve(n);
+    for (size_t i = 0; i < n; ++i) keys.push_back(KeyGen::make(i + offset));
+    return keys;
+}
+
+template<class Map, class Keys>
+Map make_map(const Keys& keys) {
+    Map m;
+    for (size_t i = 0; i < keys.size(); ++i) m.emplace(keys[i], i);
+    return m;
+}
+
+template<class Map, class KeyGen>
+void bm_insert(benchmark::State& state) {
+    auto keys = make_keys<KeyGen>(state.range(0), 0);
+    for (auto _ : state) {
+        Map m;
+        for (size_t i = 0; i < keys.size(); ++i) m.insert({ keys[i], i });
+        benchmark::DoNotOptimize(m);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<class Map, class KeyGen>
+void bm_emplace(benchmark::State& state) {
+    auto keys = make_keys<KeyGen>(state.range(0), 0);
+    for (auto _ : state) {
+        Map m;
+        for (size_t i = 0; i < keys.size(); ++i) m.emplace(keys[i], i);
+        benchmark::DoNotOptimize(m);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<class Map, class KeyGen>
+void bm_subscript(benchmark::State& state) {
+    auto keys = make_keys<KeyGen>(state.range(0), 0);
+    for (auto _ : state) {
+        Map m;
+        for (size_t i = 0; i < keys.size(); ++i) m[keys[i]] = i;
+        benchmark::DoNotOptimize(m);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Looks up every key once per iteration, in an order unrelated to the
+// insertion order. Misses use keys from a disjoint range.
+template<class Map, class KeyGen, bool Hit>
+void bm_find(benchmark::State& state) {
+    auto keys = make_keys<KeyGen>(state.range(0), 0);
+    Map m = make_map<Map>(keys);
+    auto probes = Hit ? keys : make_keys<KeyGen>(state.range(0), state.range(0));
+    std::shuffle(probes.begin(), probes.end(), std::mt19937_64(42));
+    for (auto _ : state) {
+        size_t found = 0;
+        for (const auto& k : probes) found += m.find(k) != m.end();
+        benchmark::DoNotOptimize(found);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<class Map, class KeyGen>
+void bm_erase(benchmark::State& state) {
+    auto keys = make_keys<KeyGen>(state.range(0), 0);
+    auto order = keys;
+    std::shuffle(order.begin(), order.end(), std::mt19937_64(42));
+    for (auto _ : state) {
+        state.PauseTiming();
+        Map m = make_map<Map>(keys);
+        state.ResumeTiming();
+        for (const auto& k : order) m.erase(k);
+        benchmark::DoNotOptimize(m);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<class Map, class KeyGen>
+void bm_iterate(benchmark::State& state) {
+    Map m = make_map<Map>(make_keys<KeyGen>(state.range(0), 0));
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        for (const auto& kv : m) sum += kv.second;
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Reads every key and none of the values, as a scan filtering on keys does.
+template<class Map, class KeyGen>
+void bm_scan_keys(benchmark::State& state) {
+    Map m = make_map<Map>(make_keys<KeyGen>(state.range(0), 0));
+    for (auto _ : state) {
+        uint64_t odd = 0;
+        for_each_key(m, [&odd](const typename KeyGen::type& key) { odd += key_bit(key); });
+        benchmark::DoNotOptimize(odd);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Doubles the bucket count of a full map.
+template<class Map, class KeyGen>
+void bm_rehash(benchmark::State& state) {
+    auto keys = make_keys<KeyGen>(state.range(0), 0);
+    for (auto _ : state) {
+        state.PauseTiming();
+        Map m = make_map<Map>(keys);
+        size_t target = m.bucket_count() * 2;
+        state.ResumeTiming();
+        m.rehash(target);
+        benchmark::DoNotOptimize(m);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<class Map, class KeyGen>
+void bm_copy(benchmark::State& state) {
+    Map m = make_map<Map>(make_keys<KeyGen>(state.range(0), 0));
+    for (auto _ : state) {
+        Map copy(m);
+        benchmark::DoNotOptimize(copy);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<template<class, class> class MapFor, class KeyGen>
+void register_key(const std::string& map_name) {
+    using Map = MapFor<typename KeyGen::type, uint64_t>;
+    struct Op {
+        const char* name;
+        void (*run)(benchmark::State&);
+    };
+    const Op ops[] = {
+        { "insert", bm_insert<Map, KeyGen> },
+        { "emplace", bm_emplace<Map, KeyGen> },
+        { "operator[]", bm_subscript<Map, KeyGen> },
+        { "find_hit", bm_find<Map, KeyGen, true> },
+        { "find_miss", bm_find<Map, KeyGen, false> },
+        { "erase", bm_erase<Map, KeyGen> },
+        { "iterate", bm_iterate<Map, KeyGen> },
+        { "rehash", bm_rehash<Map, KeyGen> },
+        { "copy", bm_copy<Map, KeyGen> },
+    };
+    for (const Op& op : ops) {
+        std::string name = std::string(op.name) + "/" + map_name + "/" + KeyGen::name;
+        benchmark::RegisterBenchmark(name.c_str(), op.run)
+            ->RangeMultiplier(10)
+            ->Range(1000, UNORDERED_MAP_BENCH_MAX_SIZE)
+            ->Unit(benchmark::kMillisecond);
+    }
+}
+
+template<template<class, class> class MapFor>
+void register_map(const std::string& map_name) {
+    register_key<MapFor, IntKey>(map_name);
+    register_key<MapFor, SequentialIntKey>(map_name);
+    register_key<MapFor, StridedIntKey>(map_name);
+    register_key<MapFor, StringKey<16>>(map_name);
+    register_key<MapFor, StringKey<64>>(map_name);
+}
+
+template<template<class, class> class MapFor, class KeyGen>
+void register_layout_key(const std::string& map_name) {
+    using Map = MapFor<typename KeyGen::type, Payload>;
+    struct Op {
+        const char* name;
+        void (*run)(benchmark::State&);
+    };
+    const Op ops[] = {
+        { "insert", bm_insert<Map, KeyGen> },
+        { "find_hit", bm_find<Map, KeyGen, true> },
+        { "find_miss", bm_find<Map, KeyGen, false> },
+        { "erase", bm_erase<Map, KeyGen> },
+        { "scan_keys", bm_scan_keys<Map, KeyGen> },
+    };
+    for (const Op& op : ops) {
+        std::string name = std::string(op.name) + "/" + map_name + "/" + KeyGen::name + ".v256";
+        benchmark::RegisterBenchmark(name.c_str(), op.run)
+            ->RangeMultiplier(10)
+            ->Range(1000, LAYOUT_MAX_SIZE)
+            ->Unit(benchmark::kMillisecond);
+    }
+}
+
+template<template<class, class> class MapFor>
+void register_layout(const std::string& map_name) {
+    register_layout_key<MapFor, IntKey>(map_name);
+    register_layout_key<MapFor, StringKey<16>>(map_name);
+}
+
+template<template<class, class> class MapFor>
+void register_flood(const std::string& map_name) {
+    using Map = MapFor<FloodKey::type, uint64_t>;
+    struct Op {
+        const char* name;
+        void (*run)(benchmark::State&);
+    };
+    const Op ops[] = {
+        { "insert", bm_insert<Map, FloodKey> },
+        { "find_hit", bm_find<Map, FloodKey, true> },
+        { "find_miss", bm_find<Map, FloodKey, false> },
+    };
+    for (const Op& op : ops) {
+        std::string name = std::string(op.name) + "/" + map_name + "/" + FloodKey::name;
+        benchmark::RegisterBenchmark(name.c_str(), op.run)
+            ->RangeMultiplier(10)
+            ->Range(1000, UNORDERED_MAP_BENCH_MAX_SIZE)
+            ->Unit(benchmark::kMillisecond);
+    }
+}
+
+template<class K, class V>
+using ChainedMap = UnorderedMap<K, V>;
+template<class K, class V>
+using FlatMap = UnorderedMap<K, V, std::hash<K>, std::equal_to<K>, FlatStorage>;
+template<class K, class V>
+using SplitMap = SplitUnorderedMap<K, V>;
+template<class K, class V>
+using SeededMap = UnorderedMap<K, V, SeededHash<>>;
+template<class K, class V>
+using FlatSeededMap = UnorderedMap<K, V, SeededHash<>, std::equal_to<K>, FlatStorage>;
+template<class K, class V>
+using StdMap = std::unordered_map<K, V>;
+#if defined(UNORDERED_MAP_BENCH_ABSL)
+template<class K, class V>
+using AbslMap = absl::flat_hash_map<K, V>;
+#endif
+#if defined(UNORDERED_MAP_BENCH_BOOST)
+template<class K, class V>
+using BoostMap = boost::unordered_flat_map<K, V>;
+#endif
+
+} // namespace
+
+int main(int argc, char** argv) {
+    register_map<ChainedMap>("UnorderedMap");
+    register_map<FlatMap>("UnorderedMap<Flat>");
+    register_map<SplitMap>("SplitUnorderedMap");
+    register_map<StdMap>("std::unordered_map");
+#if defined(UNORDERED_MAP_BENCH_ABSL)
+    register_map<AbslMap>("absl::flat_hash_map");
+#endif
+#if defined(UNORDERED_MAP_BENCH_BOOST)
+    register_map<BoostMap>("boost::unordered_flat_map");
+#endif
+    register_layout<ChainedMap>("UnorderedMap");
+    register_layout<FlatMap>("UnorderedMap<Flat>");
+    register_layout<SplitMap>("SplitUnorderedMap");
+    register_flood<SeededMap>("UnorderedMap<Seeded>");
+    register_flood<FlatSeededMap>("UnorderedMap<Flat,Seeded>");
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
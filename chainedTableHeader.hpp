@@ -0,0 +1,180 @@
+#ifndef CHAINED_TABLE_HPP
+#define CHAINED_TABLE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "controlGroupHeader.hpp"
+#include "indexPoliciesHeader.hpp"
+#include "statsPolicyHeader.hpp"
+#include "threadPoolHeader.hpp"
+
+namespace detail {
+
+// List node payload: the element, plus its full hash when StoreHash is set.
+template<typename Value, bool StoreHash>
+struct ChainNode {
+    template<typename... Args>
+    explicit ChainNode(size_t, Args&&... args) : value(std::forward<Args>(args)...) {}
+
+    bool hash_equals(size_t) const { return true; }
+    template<typename HashOf>
+    size_t hash(const HashOf& hash_of) const { return hash_of(value); }
+    void set_hash(size_t) {}
+
+    Value value;
+};
+
+template<typename Value>
+struct ChainNode<Value, true> {
+    template<typename... Args>
+    explicit ChainNode(size_t h, Args&&... args) : value(std::forward<Args>(args)...), stored_hash(h) {}
+
+    bool hash_equals(size_t h) const { return stored_hash == h; }
+    template<typename HashOf>
+    size_t hash(const HashOf&) const { return stored_hash; }
+    void set_hash(size_t h) { stored_hash = h; }
+
+    Value value;
+    size_t stored_hash;
+};
+
+// List of chain nodes: a bucket of a chained table, and the payload of the
+// map's node handles for every storage engine.
+template<typename Value, bool StoreHash, typename Allocator>
+using chain_list = std::list<ChainNode<Value, StoreHash>,
+                             typename std::allocator_traits<Allocator>::template rebind_alloc<ChainNode<Value, StoreHash>>>;
+
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+class ChainedTable {
+public:
+    using value_type = Value;
+    using size_type = size_t;
+    using allocator_type = Allocator;
+    using node_type = ChainNode<value_type, StoreHash>;
+    using node_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<node_type>;
+    using bucket_type = chain_list<value_type, StoreHash, Allocator>;
+    using node_list = bucket_type;
+    using bucket_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<bucket_type>;
+
+    struct position {
+        size_type bucket;
+        typename bucket_type::iterator node;
+
+        bool operator==(const position& o) const { return bucket == o.bucket && node == o.node; }
+        bool operator!=(const position& o) const { return !(*this == o); }
+    };
+
+    struct const_position {
+        size_type bucket;
+        typename bucket_type::const_iterator node;
+
+        bool operator==(const const_position& o) const { return bucket == o.bucket && node == o.node; }
+        bool operator!=(const const_position& o) const { return !(*this == o); }
+    };
+
+    static constexpr float default_max_load_factor = 1.0f;
+    static constexpr bool supports_parallel = true;
+    static size_type max_load(size_type bucket_count, float max_load_factor);
+
+    ChainedTable(size_type bucket_count, const Allocator& alloc);
+    ChainedTable(const ChainedTable& other, const Allocator& alloc);
+    ChainedTable(ChainedTable&& other) noexcept;
+    ChainedTable& operator=(ChainedTable&& other) noexcept;
+
+    allocator_type get_allocator() const;
+    size_type bucket_count() const;
+    size_type bucket_size(size_type i) const;
+    size_type index_for(size_type hash) const;
+    size_type tombstones() const;
+
+    template<typename K, typename Eq>
+    position find(const K& key, size_type hash, const Eq& eq);
+    template<typename K, typename Eq>
+    const_position find(const K& key, size_type hash, const Eq& eq) const;
+    template<typename K, typename Eq>
+    const_position find(const K& key, size_type hash, const Eq& eq, size_type& probes) const;
+    void prefetch(size_type hash) const;
+    void prefetch_chain(size_type hash) const;
+    template<typename K, typename Eq>
+    size_type probe_length(const K& key, size_type hash, const Eq& eq) const;
+    MemoryUsage memory_usage() const;
+    template<typename... Args>
+    position emplace(size_type hash, Args&&... args);
+    void erase(const position& pos);
+    void extract(const position& pos, node_list& into);
+    position insert_node(size_type hash, node_list& from);
+    static const_position to_const(const position& pos);
+    position to_mutable(const const_position& pos);
+    void clear();
+    template<typename HashOf>
+    void rehash(size_type new_count, const HashOf& hash_of);
+    template<typename HashOf, typename Executor>
+    void rehash(size_type new_count, const HashOf& hash_of, Executor& executor);
+    template<typename HashOf>
+    void reseed(const HashOf& hash_of);
+    template<typename It, typename Eq, typename Executor>
+    void insert_parallel(It first, const size_type* hashes, size_type n, const Eq& eq, Executor& executor,
+                         size_type& inserted, std::vector<size_type>& deferred);
+    template<typename HashOf>
+    void transfer_bucket(size_type i, ChainedTable& into, const HashOf& hash_of);
+    void swap(ChainedTable& other) noexcept;
+
+    position begin();
+    position end();
+    const_position begin() const;
+    const_position end() const;
+    size_type segments() const;
+    position seek(size_type segment);
+    const_position seek(size_type segment) const;
+    void next(position& pos);
+    void next(const_position& pos) const;
+    template<typename F>
+    void for_each(F& f);
+    template<typename F>
+    void for_each(F& f) const;
+    template<typename F, typename HashOf>
+    void for_each_hashed(F& f, const HashOf& hash_of) const;
+    value_type& value(const position& pos);
+    const value_type& value(const const_position& pos) const;
+
+private:
+    using bucket_array = std::vector<bucket_type, bucket_allocator>;
+    using word_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<uint64_t>;
+    using bitmap_type = std::vector<uint64_t, word_allocator>;
+
+    // Fewest buckets a task of a parallel rehash or insert works on. Regions
+    // are whole multiples of 64 buckets so that no two tasks share a word
+    // of the occupancy bitmap.
+    static constexpr size_type PARALLEL_REGION = 4096;
+
+    static bucket_array make_buckets(size_type bucket_count, const Allocator& alloc);
+    static size_type bitmap_words(size_type bucket_count);
+    void mark_occupied(size_type i);
+    void mark_empty(size_type i);
+    size_type next_occupied(size_type from) const;
+
+    bucket_array buckets_;
+    // One bit per bucket, set while the bucket holds at least one node, so
+    // iteration skips runs of empty buckets 64 at a time.
+    bitmap_type occupied_;
+    // Lowest non-empty bucket, or bucket_count() when the table is empty.
+    size_type first_;
+};
+
+} // namespace detail
+
+struct ChainedStorage {
+    template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+    using table = detail::ChainedTable<Value, IndexPolicy, StoreHash, Allocator>;
+};
+
+#include "chainedTableImplementation.tpp"
+
+#endif
@@ -0,0 +1,782 @@
+#include "chainedTableHeader.hpp"
+
+namespace detail {
+
+//******************************************************************************
+//* @brief Returns the largest number of elements the table may hold with the *
+//* given bucket count before it has to grow.                          *
+//* *
+//* @param bucket_count    The number of buckets.                             *
+//* @param max_load_factor The maximum average number of elements per bucket.*
+//* @return The element limit for that bucket count.                          *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::size_type
+ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::max_load(size_type bucket_count, float max_load_factor) {
+    return static_cast<size_type>(bucket_count * max_load_factor);
+}
+
+//******************************************************************************
+//* @brief Builds an array of empty buckets that all share alloc. Each list is*
+//* constructed from the allocator itself rather than copied from a    *
+//* prototype, since copying would go through                          *
+//* select_on_container_copy_construction() and could leave buckets     *
+//* with allocators that compare unequal, which splice() forbids.      *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::bucket_array
+ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::make_buckets(size_type bucket_count, const Allocator& alloc) {
+    bucket_array buckets{bucket_allocator(alloc)};
+    buckets.reserve(bucket_count);
+    node_allocator node_alloc(alloc);
+    for (size_type i = 0; i < bucket_count; ++i) buckets.push_back(bucket_type(node_alloc));
+    return buckets;
+}
+
+//******************************************************************************
+//* @brief Constructs a table of empty buckets. The bucket array and every   *
+//* list node are allocated through a rebound copy of alloc.           *
+//* *
+//* @param bucket_count The number of buckets to allocate.                   *
+//* @param alloc        The allocator to draw memory from.                   *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::ChainedTable(size_type bucket_count, const Allocator& alloc)
+    : buckets_(make_buckets(bucket_count, alloc)),
+      occupied_(bitmap_words(bucket_count), 0, word_allocator(alloc)),
+      first_(bucket_count) {}
+
+//******************************************************************************
+//* @brief Clone constructor. Builds the same number of buckets as other and *
+//* copies every chain node for node, stored hash included, so no key  *
+//* is hashed or compared.                                              *
+//* *
+//* @param other The table to copy.                                          *
+//* @param alloc The allocator for the bucket array and the new nodes.       *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::ChainedTable(const ChainedTable& other, const Allocator& alloc)
+    : ChainedTable(other.bucket_count(), alloc) {
+    for (size_type i = 0; i < buckets_.size(); ++i) {
+        for (const node_type& node : other.buckets_[i]) buckets_[i].push_back(node);
+    }
+    std::copy(other.occupied_.begin(), other.occupied_.end(), occupied_.begin());
+    first_ = other.first_;
+}
+
+//******************************************************************************
+//* @brief Move constructor. Takes over the buckets of other and leaves it   *
+//* with none.                                                          *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::ChainedTable(ChainedTable&& other) noexcept
+    : buckets_(std::move(other.buckets_)), occupied_(std::move(other.occupied_)), first_(other.first_) {
+    other.buckets_.clear();
+    other.occupied_.clear();
+    other.first_ = 0;
+}
+
+//******************************************************************************
+//* @brief Move assignment. Takes over the bucket array of other. The map    *
+//* only moves tables whose allocators may be exchanged, so the buckets *
+//* are stolen, never assigned node by node.                            *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+ChainedTable<Value, IndexPolicy, StoreHash, Allocator>& ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::operator=(ChainedTable&& other) noexcept {
+    if (this != &other) {
+        ChainedTable tmp(std::move(other));
+        swap(tmp);
+    }
+    return *this;
+}
+
+//******************************************************************************
+//* @brief Returns a copy of the allocator the table was constructed with.   *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::allocator_type
+ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::get_allocator() const {
+    return allocator_type(buckets_.get_allocator());
+}
+
+//******************************************************************************
+//* @brief Returns the number of buckets.                                     *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::size_type ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::bucket_count() const {
+    return buckets_.size();
+}
+
+//******************************************************************************
+//* @brief Returns the number of elements chained in bucket i.               *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::size_type ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::bucket_size(size_type i) const {
+    return buckets_[i].size();
+}
+
+//******************************************************************************
+//* @brief Maps a hash value to the index of the bucket it belongs to, as    *
+//* defined by the index policy. A table with no buckets maps every hash *
+//* to 0 instead of dividing by zero.                                   *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::size_type ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::index_for(size_type hash) const {
+    return IndexPolicy::index(IndexPolicy::mix(hash), buckets_.size() + buckets_.empty());
+}
+
+//******************************************************************************
+//* @brief Returns the number of erased-but-unreclaimed slots. Chaining frees *
+//* nodes eagerly, so this is always zero.                               *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::size_type ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::tombstones() const {
+    return 0;
+}
+
+//******************************************************************************
+//* @brief Looks up a key in the bucket selected by its hash. When hashes are *
+//* stored, a node whose hash differs is rejected without calling eq.   *
+//* A table with no buckets, as built lazily or left by a move, holds  *
+//* nothing and returns end() after one well-predicted test.           *
+//* *
+//* @param key  The key to search for.                                        *
+//* @param hash The hash of the key.                                          *
+//* @param eq   The key equality predicate.                                   *
+//* @return The position of the matching element, or end().                  *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename K, typename Eq>
+typename ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::position
+ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::find(const K& key, size_type hash, const Eq& eq) {
+    if (buckets_.empty()) return end();
+    size_type idx = index_for(hash);
+    for (auto it = buckets_[idx].begin(); it != buckets_[idx].end(); ++it) {
+        if (it->hash_equals(hash) && eq(it->value.first, key)) {
+            return { idx, it };
+        }
+    }
+    return end();
+}
+
+//******************************************************************************
+//* @brief Looks up a key in the bucket selected by its hash (const version).*
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename K, typename Eq>
+typename ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::const_position
+ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::find(const K& key, size_type hash, const Eq& eq) const {
+    if (buckets_.empty()) return end();
+    size_type idx = index_for(hash);
+    for (auto it = buckets_[idx].cbegin(); it != buckets_[idx].cend(); ++it) {
+        if (it->hash_equals(hash) && eq(it->value.first, key)) {
+            return { idx, it };
+        }
+    }
+    return end();
+}
+
+//******************************************************************************
+//* @brief Looks up a key like find() and also counts the nodes visited,  *
+//* as probe_length() reports them, so that a caller needing both walks *
+//* the chain once.                                                     *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename K, typename Eq>
+typename ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::const_position
+ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::find(const K& key, size_type hash, const Eq& eq, size_type& probes) const {
+    probes = 0;
+    if (buckets_.empty()) return end();
+    size_type idx = index_for(hash);
+    for (auto it = buckets_[idx].cbegin(); it != buckets_[idx].cend(); ++it) {
+        ++probes;
+        if (it->hash_equals(hash) && eq(it->value.first, key)) {
+            return { idx, it };
+        }
+    }
+    return end();
+}
+
+//******************************************************************************
+//* @brief Starts loading the bucket a hash selects into the cache.          *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::prefetch(size_type hash) const {
+    detail::prefetch(buckets_.data() + index_for(hash));
+}
+
+//******************************************************************************
+//* @brief Starts loading the first node of the bucket a hash selects. Reads *
+//* the bucket itself, so it should follow prefetch() by a while.      *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::prefetch_chain(size_type hash) const {
+    if (buckets_.empty()) return;
+    const bucket_type& bucket = buckets_[index_for(hash)];
+    if (!bucket.empty()) detail::prefetch(&bucket.front());
+}
+
+//******************************************************************************
+//* @brief Counts the nodes a lookup for key visits: its position in the    *
+//* chain on a hit, the whole chain on a miss.                          *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename K, typename Eq>
+typename ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::size_type
+ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::probe_length(const K& key, size_type hash, const Eq& eq) const {
+    size_type probes;
+    find(key, hash, eq, probes);
+    return probes;
+}
+
+//******************************************************************************
+//* @brief Reports the memory held by the bucket array and occupancy bitmap, *
+//* and by the list nodes, counting two links per node and one        *
+//* allocation each. Walks the occupied buckets.                        *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+MemoryUsage ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::memory_usage() const {
+    size_type nodes = 0;
+    for (size_type i = first_; i < buckets_.size(); i = next_occupied(i + 1)) nodes += buckets_[i].size();
+    MemoryUsage usage;
+    usage.table = buckets_.capacity() * sizeof(bucket_type) + occupied_.capacity() * sizeof(uint64_t);
+    usage.nodes = nodes * (sizeof(node_type) + 2 * sizeof(void*));
+    usage.allocations = nodes + (buckets_.capacity() != 0) + (occupied_.capacity() != 0);
+    return usage;
+}
+
+//******************************************************************************
+//* @brief Appends a new element to the bucket selected by its hash. The     *
+//* caller guarantees that the key is not already present.               *
+//* *
+//* @param hash The hash of the new element's key.                           *
+//* @param args Arguments forwarded to the value_type constructor.           *
+//* @return The position of the new element.                                *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename... Args>
+typename ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::position
+ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::emplace(size_type hash, Args&&... args) {
+    size_type idx = index_for(hash);
+    buckets_[idx].emplace_back(hash, std::forward<Args>(args)...);
+    mark_occupied(idx);
+    return { idx, std::prev(buckets_[idx].end()) };
+}
+
+//******************************************************************************
+//* @brief Removes the element at the given position.                        *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::erase(const position& pos) {
+    buckets_[pos.bucket].erase(pos.node);
+    if (buckets_[pos.bucket].empty()) mark_empty(pos.bucket);
+}
+
+
+//******************************************************************************
+//* @brief Moves the node at a position onto the end of another list. The  *
+//* node is relinked, so the element is neither copied nor moved and   *
+//* keeps its address. into must use an allocator equal to the table's.*
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::extract(const position& pos, node_list& into) {
+    into.splice(into.end(), buckets_[pos.bucket], pos.node);
+    if (buckets_[pos.bucket].empty()) mark_empty(pos.bucket);
+}
+
+//******************************************************************************
+//* @brief Relinks the first node of a list into the bucket its hash       *
+//* selects, as emplace() would place a new element. The caller        *
+//* guarantees that the key is not already present and that the list's *
+//* allocator equals the table's.                                       *
+//* *
+//* @param hash The hash of the node's key.                                  *
+//* @param from The list to take the node from; must not be empty.          *
+//* @return The position of the inserted element.                           *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::position ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::insert_node(size_type hash, node_list& from) {
+    from.front().set_hash(hash);
+    size_type idx = index_for(hash);
+    buckets_[idx].splice(buckets_[idx].end(), from, from.begin());
+    mark_occupied(idx);
+    return { idx, std::prev(buckets_[idx].end()) };
+}
+
+//******************************************************************************
+//* @brief Converts a position to its read-only form.                        *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::const_position
+ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::to_const(const position& pos) {
+    return { pos.bucket, pos.node };
+}
+
+//******************************************************************************
+//* @brief Converts a read-only position back to a mutable one. The empty  *
+//* range erase is the standard way to turn a list const_iterator into  *
+//* an iterator; it removes nothing and runs in constant time.         *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::position
+ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::to_mutable(const const_position& pos) {
+    if (pos.bucket >= buckets_.size()) return end();
+    return { pos.bucket, buckets_[pos.bucket].erase(pos.node, pos.node) };
+}
+
+//******************************************************************************
+//* @brief Removes every element while keeping the bucket array.             *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::clear() {
+    for (size_type i = first_; i < buckets_.size(); i = next_occupied(i + 1)) buckets_[i].clear();
+    std::fill(occupied_.begin(), occupied_.end(), 0);
+    first_ = buckets_.size();
+}
+
+//******************************************************************************
+//* @brief Redistributes all elements over a new array of buckets. Nodes are *
+//* spliced into their new bucket rather than copied, so rehashing       *
+//* allocates nothing besides the bucket array and every element keeps   *
+//* its address.                                                         *
+//* *
+//* @param new_count The new number of buckets.                              *
+//* @param hash_of   Returns the hash of an element; unused when hashes are  *
+//* stored.                                                 *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename HashOf>
+void ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::rehash(size_type new_count, const HashOf& hash_of) {
+    bucket_array new_buckets = make_buckets(new_count, get_allocator());
+    bitmap_type new_occupied(bitmap_words(new_count), 0, occupied_.get_allocator());
+    size_type new_first = new_count;
+    for (size_type i = first_; i < buckets_.size(); i = next_occupied(i + 1)) {
+        bucket_type& bucket = buckets_[i];
+        while (!bucket.empty()) {
+            auto node = bucket.begin();
+            size_type idx = IndexPolicy::index(IndexPolicy::mix(node->hash(hash_of)), new_count);
+            new_buckets[idx].splice(new_buckets[idx].end(), bucket, node);
+            new_occupied[idx / 64] |= uint64_t(1) << (idx % 64);
+            if (idx < new_first) new_first = idx;
+        }
+    }
+    buckets_.swap(new_buckets);
+    occupied_.swap(new_occupied);
+    first_ = new_first;
+}
+
+//******************************************************************************
+//* @brief Recomputes every hash after the hash function changed and       *
+//* redistributes the nodes over a new array of the same size. The      *
+//* array is allocated before any node moves, so only hash_of can fail *
+//* midway, and it must not throw.                                      *
+//* *
+//* @param hash_of Returns the new hash of an element.                     *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename HashOf>
+void ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::reseed(const HashOf& hash_of) {
+    size_type count = buckets_.size();
+    bucket_array new_buckets = make_buckets(count, get_allocator());
+    bitmap_type new_occupied(bitmap_words(count), 0, occupied_.get_allocator());
+    size_type new_first = count;
+    for (size_type i = first_; i < count; i = next_occupied(i + 1)) {
+        bucket_type& bucket = buckets_[i];
+        while (!bucket.empty()) {
+            auto node = bucket.begin();
+            size_type hash = hash_of(node->value);
+            node->set_hash(hash);
+            size_type idx = IndexPolicy::index(IndexPolicy::mix(hash), count);
+            new_buckets[idx].splice(new_buckets[idx].end(), bucket, node);
+            new_occupied[idx / 64] |= uint64_t(1) << (idx % 64);
+            if (idx < new_first) new_first = idx;
+        }
+    }
+    buckets_.swap(new_buckets);
+    occupied_.swap(new_occupied);
+    first_ = new_first;
+}
+
+//******************************************************************************
+//* @brief Redistributes all elements over a new array of buckets using an  *
+//* executor. Nodes are still spliced, never copied. The old buckets   *
+//* are split into spans and the new ones into regions. First every    *
+//* span works out the new bucket of each of its nodes, which is the   *
+//* only step that calls hash_of or allocates; then it moves its nodes *
+//* onto one list per region; finally every region links the nodes    *
+//* from all spans into its own buckets. An exception from the first  *
+//* step leaves the table unchanged. Tables too small to split use the  *
+//* serial path.                                                        *
+//* *
+//* @param new_count The new number of buckets.                              *
+//* @param hash_of   Returns the hash of an element; called in parallel, and *
+//* unused when hashes are stored.                          *
+//* @param executor  Runs the tasks; see ThreadPool.                         *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename HashOf, typename Executor>
+void ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::rehash(size_type new_count, const HashOf& hash_of, Executor& executor) {
+    size_type wanted = 4 * executor.concurrency();
+    size_type region = detail::region_length(new_count, wanted, PARALLEL_REGION, 64);
+    if (region == new_count || buckets_.empty()) {
+        rehash(new_count, hash_of);
+        return;
+    }
+    size_type regions = (new_count + region - 1) / region;
+    size_type span = detail::region_length(buckets_.size(), wanted, PARALLEL_REGION, 64);
+    size_type spans = (buckets_.size() + span - 1) / span;
+
+    bucket_array new_buckets = make_buckets(new_count, get_allocator());
+    bitmap_type new_occupied(bitmap_words(new_count), 0, occupied_.get_allocator());
+    node_allocator node_alloc(get_allocator());
+    std::vector<bucket_type> moved;
+    moved.reserve(spans * regions);
+    for (size_type k = 0; k < spans * regions; ++k) moved.push_back(bucket_type(node_alloc));
+    // Per span: the new bucket of each node in visiting order, then the
+    // same indices grouped by region, and where each region's group starts.
+    std::vector<std::vector<size_type>> index(spans), sorted(spans);
+    std::vector<size_type> offsets(spans * (regions + 1), 0);
+
+    auto for_each_bucket = [&](size_type t, auto&& f) {
+        size_type end = std::min((t + 1) * span, buckets_.size());
+        for (size_type i = next_occupied(t * span); i < end; i = next_occupied(i + 1)) f(buckets_[i]);
+    };
+    executor.run(spans, [&](size_t t) {
+        size_type nodes = 0;
+        for_each_bucket(t, [&](const bucket_type& bucket) { nodes += bucket.size(); });
+        index[t].reserve(nodes);
+        sorted[t].resize(nodes);
+        size_type* offset = offsets.data() + t * (regions + 1);
+        for_each_bucket(t, [&](const bucket_type& bucket) {
+            for (const node_type& node : bucket) {
+                size_type idx = IndexPolicy::index(IndexPolicy::mix(node.hash(hash_of)), new_count);
+                index[t].push_back(idx);
+                ++offset[idx / region + 1];
+            }
+        });
+        for (size_type r = 0; r < regions; ++r) offset[r + 1] += offset[r];
+    });
+    executor.run(spans, [&](size_t t) {
+        const size_type* offset = offsets.data() + t * (regions + 1);
+        std::vector<size_type> cursor(offset, offset + regions);
+        size_type k = 0;
+        for_each_bucket(t, [&](bucket_type& bucket) {
+            while (!bucket.empty()) {
+                size_type idx = index[t][k++];
+                size_type r = idx / region;
+                sorted[t][cursor[r]++] = idx;
+                bucket_type& to = moved[t * regions + r];
+                to.splice(to.end(), bucket, bucket.begin());
+            }
+        });
+    });
+    std::vector<size_type> firsts(regions, new_count);
+    executor.run(regions, [&](size_t r) {
+        for (size_type t = 0; t < spans; ++t) {
+            bucket_type& from = moved[t * regions + r];
+            const size_type* offset = offsets.data() + t * (regions + 1);
+            for (size_type k = offset[r]; k < offset[r + 1]; ++k) {
+                size_type idx = sorted[t][k];
+                new_buckets[idx].splice(new_buckets[idx].end(), from, from.begin());
+                new_occupied[idx / 64] |= uint64_t(1) << (idx % 64);
+                if (idx < firsts[r]) firsts[r] = idx;
+            }
+        }
+    });
+    buckets_.swap(new_buckets);
+    occupied_.swap(new_occupied);
+    first_ = *std::min_element(firsts.begin(), firsts.end());
+}
+
+//******************************************************************************
+//* @brief Inserts a batch of elements using an executor. The buckets are   *
+//* split into regions of whole bitmap words and every task appends the *
+//* items whose bucket lies in its region, skipping keys already in the *
+//* bucket. Items of a region are handled in input order, so of several *
+//* equal keys the first one wins, as with insert(). Every item finds  *
+//* room, so deferred only fills when the table is too small to split. *
+//* *
+//* @param first    The first item; item i is *(first + i).                 *
+//* @param hashes   The hash of each item's key.                            *
+//* @param n        The number of items.                                     *
+//* @param eq       The key equality predicate.                             *
+//* @param executor Runs the tasks; see ThreadPool.                          *
+//* @param inserted Set to the number of elements inserted, also when a    *
+//* task throws.                                              *
+//* @param deferred Receives the indices of the items left to the caller. *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename It, typename Eq, typename Executor>
+void ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::insert_parallel(It first, const size_type* hashes, size_type n, const Eq& eq,
+                                                                            Executor& executor, size_type& inserted,
+                                                                            std::vector<size_type>& deferred) {
+    inserted = 0;
+    size_type region = detail::region_length(buckets_.size(), 4 * executor.concurrency(), PARALLEL_REGION, 64);
+    if (region == buckets_.size()) {
+        for (size_type i = 0; i < n; ++i) deferred.push_back(i);
+        return;
+    }
+    size_type regions = (buckets_.size() + region - 1) / region;
+    detail::RegionPartition partition(executor, n, regions, [&](size_type i) { return index_for(hashes[i]) / region; });
+
+    std::vector<size_type> counts(regions, 0);
+    auto fill = [&](size_t r) {
+        partition.for_each(r, [&](size_type i) {
+            const auto& item = *(first + i);
+            size_type hash = hashes[i];
+            size_type idx = index_for(hash);
+            bucket_type& bucket = buckets_[idx];
+            for (const node_type& node : bucket) {
+                if (node.hash_equals(hash) && eq(node.value.first, item.first)) return;
+            }
+            bucket.emplace_back(hash, item);
+            occupied_[idx / 64] |= uint64_t(1) << (idx % 64);
+            ++counts[r];
+        });
+    };
+    auto finish = [&] {
+        for (size_type r = 0; r < regions; ++r) inserted += counts[r];
+        first_ = next_occupied(0);
+    };
+    try {
+        executor.run(regions, fill);
+    } catch (...) {
+        finish();
+        throw;
+    }
+    finish();
+}
+
+//******************************************************************************
+//* @brief Splices every node of bucket i into the bucket of another table   *
+//* that its hash selects. Both tables must use equal allocators; the   *
+//* nodes are relinked, not copied.                                     *
+//* *
+//* @param i       The bucket to empty.                                      *
+//* @param into    The table that receives the nodes.                        *
+//* @param hash_of Returns the hash of an element; unused when hashes are    *
+//* stored.                                                   *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename HashOf>
+void ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::transfer_bucket(size_type i, ChainedTable& into, const HashOf& hash_of) {
+    bucket_type& bucket = buckets_[i];
+    while (!bucket.empty()) {
+        auto node = bucket.begin();
+        size_type idx = into.index_for(node->hash(hash_of));
+        into.buckets_[idx].splice(into.buckets_[idx].end(), bucket, node);
+        into.mark_occupied(idx);
+    }
+    mark_empty(i);
+}
+
+//******************************************************************************
+//* @brief Exchanges the buckets of two tables.                              *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::swap(ChainedTable& other) noexcept {
+    using std::swap;
+    buckets_.swap(other.buckets_);
+    occupied_.swap(other.occupied_);
+    swap(first_, other.first_);
+}
+
+//******************************************************************************
+//* @brief Returns the position of the first element, or end() if the table  *
+//* is empty. The first non-empty bucket is tracked, so this is O(1).  *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::position ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::begin() {
+    if (first_ >= buckets_.size()) return end();
+    return { first_, buckets_[first_].begin() };
+}
+
+//******************************************************************************
+//* @brief Returns the past-the-end position.                                *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::position ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::end() {
+    return { buckets_.size(), {} };
+}
+
+//******************************************************************************
+//* @brief Returns the position of the first element (const version).        *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::const_position ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::begin() const {
+    if (first_ >= buckets_.size()) return end();
+    return { first_, buckets_[first_].cbegin() };
+}
+
+//******************************************************************************
+//* @brief Returns the past-the-end position (const version).                *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::const_position ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::end() const {
+    return { buckets_.size(), {} };
+}
+
+//******************************************************************************
+//* @brief Returns the number of segments iteration can be split at: one  *
+//* per bucket.                                                         *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::size_type ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::segments() const {
+    return buckets_.size();
+}
+
+//******************************************************************************
+//* @brief Returns the first element in bucket segment or later, or end().  *
+//* Positions returned for increasing segments are in iteration order, *
+//* so [seek(a), seek(b)) holds exactly the elements of buckets [a, b). *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::position ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::seek(size_type segment) {
+    size_type i = next_occupied(segment);
+    if (i >= buckets_.size()) return end();
+    return { i, buckets_[i].begin() };
+}
+
+//******************************************************************************
+//* @brief Returns the first element in bucket segment or later (const     *
+//* version).                                                           *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::const_position ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::seek(size_type segment) const {
+    size_type i = next_occupied(segment);
+    if (i >= buckets_.size()) return end();
+    return { i, buckets_[i].cbegin() };
+}
+
+//******************************************************************************
+//* @brief Moves a position to the next element in the current bucket, or to *
+//* the first element of the next non-empty bucket, found through the   *
+//* occupancy bitmap.                                                  *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::next(position& pos) {
+    if (pos.bucket >= buckets_.size()) return;
+    ++pos.node;
+    if (pos.node != buckets_[pos.bucket].end()) return;
+    pos.bucket = next_occupied(pos.bucket + 1);
+    pos.node = pos.bucket < buckets_.size() ? buckets_[pos.bucket].begin()
+                                            : typename bucket_type::iterator{};
+}
+
+//******************************************************************************
+//* @brief Moves a position to the next element (const version).             *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::next(const_position& pos) const {
+    if (pos.bucket >= buckets_.size()) return;
+    ++pos.node;
+    if (pos.node != buckets_[pos.bucket].cend()) return;
+    pos.bucket = next_occupied(pos.bucket + 1);
+    pos.node = pos.bucket < buckets_.size() ? buckets_[pos.bucket].cbegin()
+                                            : typename bucket_type::const_iterator{};
+}
+
+//******************************************************************************
+//* @brief Calls f on every element, visiting only the buckets whose bit is  *
+//* set in the occupancy bitmap.                                        *
+//* *
+//* @param f The function to call with each element.                        *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename F>
+void ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::for_each(F& f) {
+    for (size_type w = first_ / 64; w < occupied_.size(); ++w) {
+        for (uint64_t bits = occupied_[w]; bits; bits &= bits - 1) {
+            for (node_type& node : buckets_[w * 64 + countr_zero64(bits)]) f(node.value);
+        }
+    }
+}
+
+//******************************************************************************
+//* @brief Calls f on every element (const version).                         *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename F>
+void ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::for_each(F& f) const {
+    for (size_type w = first_ / 64; w < occupied_.size(); ++w) {
+        for (uint64_t bits = occupied_[w]; bits; bits &= bits - 1) {
+            for (const node_type& node : buckets_[w * 64 + countr_zero64(bits)]) f(node.value);
+        }
+    }
+}
+
+//******************************************************************************
+//* @brief Calls f(element, hash) on every element, taking the hash from   *
+//* the node when hashes are stored and from hash_of otherwise.         *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename F, typename HashOf>
+void ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::for_each_hashed(F& f, const HashOf& hash_of) const {
+    for (size_type w = first_ / 64; w < occupied_.size(); ++w) {
+        for (uint64_t bits = occupied_[w]; bits; bits &= bits - 1) {
+            for (const node_type& node : buckets_[w * 64 + countr_zero64(bits)]) f(node.value, node.hash(hash_of));
+        }
+    }
+}
+
+//******************************************************************************
+//* @brief Returns the number of 64-bit words in the occupancy bitmap of a   *
+//* table with bucket_count buckets.                                    *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::size_type ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::bitmap_words(size_type bucket_count) {
+    return (bucket_count + 63) / 64;
+}
+
+//******************************************************************************
+//* @brief Records that bucket i holds at least one node.                    *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::mark_occupied(size_type i) {
+    occupied_[i / 64] |= uint64_t(1) << (i % 64);
+    if (i < first_) first_ = i;
+}
+
+//******************************************************************************
+//* @brief Records that bucket i became empty, moving first_ past it if it   *
+//* was the first non-empty bucket.                                     *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::mark_empty(size_type i) {
+    occupied_[i / 64] &= ~(uint64_t(1) << (i % 64));
+    if (i == first_) first_ = next_occupied(i + 1);
+}
+
+//******************************************************************************
+//* @brief Returns the first non-empty bucket at or after from, or          *
+//* bucket_count(). Scans the occupancy bitmap a word at a time.        *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::size_type ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::next_occupied(size_type from) const {
+    size_type w = from / 64;
+    if (w >= occupied_.size()) return buckets_.size();
+    uint64_t bits = occupied_[w] & (~uint64_t(0) << (from % 64));
+    while (!bits) {
+        if (++w == occupied_.size()) return buckets_.size();
+        bits = occupied_[w];
+    }
+    return w * 64 + countr_zero64(bits);
+}
+
+//******************************************************************************
+//* @brief Returns the element stored at a position.                         *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::value_type& ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::value(const position& pos) {
+    return pos.node->value;
+}
+
+//******************************************************************************
+//* @brief Returns the element stored at a position (const version).         *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+const typename ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::value_type& ChainedTable<Value, IndexPolicy, StoreHash, Allocator>::value(const const_position& pos) const {
+    return pos.node->value;
+}
+
+} // namespace detail
@@ -0,0 +1,97 @@
+#ifndef CONCURRENT_UNORDERED_MAP_HPP
+#define CONCURRENT_UNORDERED_MAP_HPP
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <utility>
+
+#include "unorderedMapHeader.hpp"
+
+// Thread-safe map split into independently locked shards. A key's shard is
+// picked by detail::shard_index, from a mix of the hash that the shard's
+// own table does not use, so its slots and tags stay evenly spread.
+// Writers lock one shard exclusively, readers share it, and operations on
+// different shards never contend. Elements are only reachable through
+// copies or callbacks that run under the shard lock; no iterators or
+// references escape.
+template<
+    typename Key,
+    typename T,
+    typename Hash = std::hash<Key>,
+    typename KeyEqual = std::equal_to<Key>,
+    typename Storage = ChainedStorage,
+    typename IndexPolicy = ModuloIndex,
+    bool StoreHash = !is_trivially_hashable<Key>::value,
+    typename Allocator = std::allocator<std::pair<const Key, T>>
+>
+class ConcurrentUnorderedMap {
+public:
+    using map_type = UnorderedMap<Key, T, Hash, KeyEqual, Storage, IndexPolicy, StoreHash, Allocator>;
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<const Key, T>;
+    using size_type = size_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using allocator_type = Allocator;
+
+    explicit ConcurrentUnorderedMap(size_type shard_count = DEFAULT_SHARD_COUNT,
+                                    const Hash& hash = Hash(),
+                                    const KeyEqual& equal = KeyEqual(),
+                                    const Allocator& alloc = Allocator());
+    ConcurrentUnorderedMap(const ConcurrentUnorderedMap&) = delete;
+    ConcurrentUnorderedMap& operator=(const ConcurrentUnorderedMap&) = delete;
+
+    bool insert(const value_type& kv);
+    bool insert(value_type&& kv);
+    template<class... Args>
+    bool try_emplace(const Key& key, Args&&... args);
+    template<class M>
+    bool insert_or_assign(const Key& key, M&& obj);
+    size_type erase(const Key& key);
+
+    std::optional<T> find(const Key& key) const;
+    bool contains(const Key& key) const;
+    template<class F>
+    bool visit(const Key& key, F&& f);
+    template<class F>
+    bool visit(const Key& key, F&& f) const;
+    template<class F>
+    void visit_all(F&& f);
+    template<class F>
+    void visit_all(F&& f) const;
+    template<class F>
+    void visit_shard(size_type shard, F&& f);
+    template<class F>
+    void visit_shard(size_type shard, F&& f) const;
+
+    size_type size() const;
+    bool empty() const;
+    void clear();
+    void reserve(size_type count);
+    size_type shard_count() const;
+
+private:
+    static constexpr size_type DEFAULT_SHARD_COUNT = 16;
+    static constexpr size_type CACHE_LINE = 64;
+
+    // Aligned to a cache line so that two shards' locks never share one.
+    struct alignas(CACHE_LINE) Shard {
+        mutable std::shared_mutex mutex;
+        map_type map;
+    };
+
+    Shard& shard_for(size_type hash);
+    const Shard& shard_for(size_type hash) const;
+
+    size_type shard_bits_;
+    std::unique_ptr<Shard[]> shards_;
+    Hash hasher_;
+};
+
+#include "concurrentUnorderedMapImplementation.tpp"
+
+#endif
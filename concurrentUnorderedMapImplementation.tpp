@@ -0,0 +1,306 @@
+#include "concurrentUnorderedMapHeader.hpp"
+
+//******************************************************************************
+//* @brief Constructs an empty map with at least shard_count shards. The    *
+//* count is rounded up to a power of two so that a shard is selected  *
+//* by a plain shift of the hash.                                      *
+//* *
+//* @param shard_count The minimum number of independently locked shards.   *
+//* @param hash        The hash function object, shared by all shards.      *
+//* @param equal       The key equality predicate object.                  *
+//* @param alloc       The allocator each shard's map is built with.       *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+ConcurrentUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::ConcurrentUnorderedMap(size_type shard_count,
+                                                                                                      const Hash& hash,
+                                                                                                      const KeyEqual& equal,
+                                                                                                      const Allocator& alloc)
+    : shard_bits_(0), hasher_(hash) {
+    while ((size_type(1) << shard_bits_) < shard_count && shard_bits_ + 1 < sizeof(size_type) * 8) ++shard_bits_;
+    shards_.reset(new Shard[size_type(1) << shard_bits_]);
+    for (size_type i = 0; i < this->shard_count(); ++i) {
+        shards_[i].map = map_type(16, hash, equal, alloc);
+    }
+}
+
+//******************************************************************************
+//* @brief Returns the shard responsible for a key, given its hash. See    *
+//* detail::shard_index for why the shard's bits come from a mix of    *
+//* their own. Callers pass the same hash on to the shard's map, so    *
+//* every operation hashes its key once.                                *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename ConcurrentUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::Shard&
+ConcurrentUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::shard_for(size_type hash) {
+    return shards_[detail::shard_index(hash, shard_bits_)];
+}
+
+//******************************************************************************
+//* @brief Returns the shard responsible for a hash (const version).       *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+const typename ConcurrentUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::Shard&
+ConcurrentUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::shard_for(size_type hash) const {
+    return shards_[detail::shard_index(hash, shard_bits_)];
+}
+
+//******************************************************************************
+//* @brief Inserts a copy of a key-value pair unless the key is present.    *
+//* *
+//* @param kv The key-value pair to insert.                                   *
+//* @return True if the pair was inserted, false if the key already existed.*
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+bool ConcurrentUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::insert(const value_type& kv) {
+    size_type hash = hasher_(kv.first);
+    Shard& shard = shard_for(hash);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.map.try_emplace_hashed(hash, kv.first, kv.second).second;
+}
+
+//******************************************************************************
+//* @brief Moves a key-value pair into the map unless the key is present.   *
+//* *
+//* @param kv The key-value pair to insert.                                   *
+//* @return True if the pair was inserted, false if the key already existed.*
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+bool ConcurrentUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::insert(value_type&& kv) {
+    size_type hash = hasher_(kv.first);
+    Shard& shard = shard_for(hash);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.map.try_emplace_hashed(hash, kv.first, std::move(kv.second)).second;
+}
+
+//******************************************************************************
+//* @brief Constructs an element from key and args if the key is absent.    *
+//* Nothing is constructed when it is present.                          *
+//* *
+//* @param key  The key of the element.                                       *
+//* @param args Arguments forwarded to the constructor of the mapped value.    *
+//* @return True if an element was inserted.                                 *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<class... Args>
+bool ConcurrentUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::try_emplace(const Key& key, Args&&... args) {
+    size_type hash = hasher_(key);
+    Shard& shard = shard_for(hash);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.map.try_emplace_hashed(hash, key, std::forward<Args>(args)...).second;
+}
+
+//******************************************************************************
+//* @brief Assigns obj to the element with the given key, or inserts it.    *
+//* *
+//* @param key The key of the element.                                        *
+//* @param obj The value to assign or insert.                                 *
+//* @return True if an insertion took place, false on assignment.           *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<class M>
+bool ConcurrentUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::insert_or_assign(const Key& key, M&& obj) {
+    size_type hash = hasher_(key);
+    Shard& shard = shard_for(hash);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.map.find(key, hash);
+    if (it != shard.map.end()) {
+        it->second = std::forward<M>(obj);
+        return false;
+    }
+    return shard.map.try_emplace_hashed(hash, key, std::forward<M>(obj)).second;
+}
+
+//******************************************************************************
+//* @brief Erases the element with the specified key.                        *
+//* *
+//* @param key The key of the element to erase.                               *
+//* @return The number of elements erased (either 0 or 1).                     *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename ConcurrentUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::size_type
+ConcurrentUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::erase(const Key& key) {
+    size_type hash = hasher_(key);
+    Shard& shard = shard_for(hash);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.map.erase(key, hash);
+}
+
+//******************************************************************************
+//* @brief Looks up a key and returns a copy of its mapped value, taken      *
+//* under a shared lock.                                                *
+//* *
+//* @param key The key to search for.                                         *
+//* @return The mapped value, or an empty optional if the key is absent.     *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+std::optional<T> ConcurrentUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::find(const Key& key) const {
+    size_type hash = hasher_(key);
+    const Shard& shard = shard_for(hash);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.map.find(key, hash);
+    if (it == shard.map.end()) return std::nullopt;
+    return it->second;
+}
+
+//******************************************************************************
+//* @brief Checks whether the map contains a key.                            *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+bool ConcurrentUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::contains(const Key& key) const {
+    size_type hash = hasher_(key);
+    const Shard& shard = shard_for(hash);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.map.contains(key, hash);
+}
+
+//******************************************************************************
+//* @brief Calls f with the element for key while holding its shard lock     *
+//* exclusively, so f may modify the mapped value in place. f must not  *
+//* call back into this map.                                           *
+//* *
+//* @param key The key of the element to visit.                               *
+//* @param f   The function to call with a reference to the key-value pair.  *
+//* @return True if the key was found and f was called.                     *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<class F>
+bool ConcurrentUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::visit(const Key& key, F&& f) {
+    size_type hash = hasher_(key);
+    Shard& shard = shard_for(hash);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.map.find(key, hash);
+    if (it == shard.map.end()) return false;
+    f(*it);
+    return true;
+}
+
+//******************************************************************************
+//* @brief Calls f with the element for key while holding its shard lock     *
+//* shared (const version).                                             *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<class F>
+bool ConcurrentUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::visit(const Key& key, F&& f) const {
+    size_type hash = hasher_(key);
+    const Shard& shard = shard_for(hash);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.map.find(key, hash);
+    if (it == shard.map.end()) return false;
+    f(*it);
+    return true;
+}
+
+//******************************************************************************
+//* @brief Calls f with every element, one shard at a time, holding each     *
+//* shard lock exclusively while its elements are visited. The visit is  *
+//* not a snapshot of the whole map: shards not yet reached may change. *
+//* *
+//* @param f The function to call with a reference to each key-value pair.   *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<class F>
+void ConcurrentUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::visit_all(F&& f) {
+    for (size_type i = 0; i < shard_count(); ++i) {
+        std::unique_lock<std::shared_mutex> lock(shards_[i].mutex);
+        shards_[i].map.for_each(f);
+    }
+}
+
+//******************************************************************************
+//* @brief Calls f with every element under shared shard locks (const      *
+//* version).                                                          *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<class F>
+void ConcurrentUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::visit_all(F&& f) const {
+    for (size_type i = 0; i < shard_count(); ++i) {
+        std::shared_lock<std::shared_mutex> lock(shards_[i].mutex);
+        static_cast<const map_type&>(shards_[i].map).for_each(f);
+    }
+}
+
+//******************************************************************************
+//* @brief Calls f with every element of one shard, holding its lock       *
+//* exclusively. Shards are the natural chunks of a parallel scan: give *
+//* each worker its own shard indices in [0, shard_count()) and the     *
+//* workers never wait on one another.                                  *
+//* *
+//* @param shard The shard to visit, below shard_count().                    *
+//* @param f     The function to call with a reference to each key-value     *
+//* pair.                                                        *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<class F>
+void ConcurrentUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::visit_shard(size_type shard, F&& f) {
+    std::unique_lock<std::shared_mutex> lock(shards_[shard].mutex);
+    shards_[shard].map.for_each(f);
+}
+
+//******************************************************************************
+//* @brief Calls f with every element of one shard under its shared lock   *
+//* (const version).                                                    *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<class F>
+void ConcurrentUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::visit_shard(size_type shard, F&& f) const {
+    std::shared_lock<std::shared_mutex> lock(shards_[shard].mutex);
+    static_cast<const map_type&>(shards_[shard].map).for_each(f);
+}
+
+//******************************************************************************
+//* @brief Returns the number of elements. All shard locks are held shared   *
+//* at once, taken in index order, so the result is a consistent count  *
+//* that no concurrent insertion or erasure is half reflected in.      *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename ConcurrentUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::size_type
+ConcurrentUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::size() const {
+    const size_type n = shard_count();
+    for (size_type i = 0; i < n; ++i) shards_[i].mutex.lock_shared();
+    size_type total = 0;
+    for (size_type i = 0; i < n; ++i) total += shards_[i].map.size();
+    for (size_type i = n; i-- > 0;) shards_[i].mutex.unlock_shared();
+    return total;
+}
+
+//******************************************************************************
+//* @brief Checks whether the map is empty.                                  *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+bool ConcurrentUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::empty() const {
+    return size() == 0;
+}
+
+//******************************************************************************
+//* @brief Removes all elements, one shard at a time.                       *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+void ConcurrentUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::clear() {
+    for (size_type i = 0; i < shard_count(); ++i) {
+        std::unique_lock<std::shared_mutex> lock(shards_[i].mutex);
+        shards_[i].map.clear();
+    }
+}
+
+//******************************************************************************
+//* @brief Reserves room for count elements spread evenly over the shards.  *
+//* *
+//* @param count The total number of elements to make room for.              *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+void ConcurrentUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::reserve(size_type count) {
+    const size_type per_shard = (count + shard_count() - 1) / shard_count();
+    for (size_type i = 0; i < shard_count(); ++i) {
+        std::unique_lock<std::shared_mutex> lock(shards_[i].mutex);
+        shards_[i].map.reserve(per_shard);
+    }
+}
+
+//******************************************************************************
+//* @brief Returns the number of shards.                                     *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename ConcurrentUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::size_type
+ConcurrentUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::shard_count() const {
+    return size_type(1) << shard_bits_;
+}
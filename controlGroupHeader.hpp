@@ -0,0 +1,230 @@
+#ifndef CONTROL_GROUP_HPP
+#define CONTROL_GROUP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define UNORDERED_MAP_GROUP_SSE2 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define UNORDERED_MAP_GROUP_NEON 1
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace detail {
+
+// Control byte of a flat table slot. Full slots hold the top seven bits of
+// the element's hash, so the sign bit alone tells free slots from full ones.
+using ctrl_t = int8_t;
+
+constexpr ctrl_t CTRL_EMPTY = -128;
+constexpr ctrl_t CTRL_DELETED = -2;
+
+// Control bytes shared by every flat table with no slots: one group of
+// empty markers, so that a lookup in an empty table loads a real group and
+// stops, with no test for a missing array. Never written.
+alignas(32) inline constexpr ctrl_t EMPTY_GROUP[32] = {
+    CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY,
+    CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY,
+    CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY,
+    CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY,
+};
+
+inline int countr_zero64(uint64_t x) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long idx;
+    _BitScanForward64(&idx, x);
+    return static_cast<int>(idx);
+#else
+    return __builtin_ctzll(x);
+#endif
+}
+
+inline int countl_zero64(uint64_t x) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long idx;
+    _BitScanReverse64(&idx, x);
+    return 63 - static_cast<int>(idx);
+#else
+    return __builtin_clzll(x);
+#endif
+}
+
+// Hints that the cache line holding p will be read soon.
+inline void prefetch(const void* p) {
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_ARM64)
+    __prefetch(p);
+#elif defined(_MSC_VER) && !defined(__clang__)
+    _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#else
+    __builtin_prefetch(p);
+#endif
+}
+
+// Set of matching lanes in a group, one significant bit per lane. Lanes are
+// (1 << Shift) bits apart so that SWAR and NEON masks need no compaction.
+template<int Width, int Shift>
+class BitMask {
+public:
+    explicit BitMask(uint64_t mask) : mask_(mask) {}
+
+    explicit operator bool() const { return mask_ != 0; }
+    int lowest() const { return countr_zero64(mask_) >> Shift; }
+    void clear_lowest() { mask_ &= mask_ - 1; }
+    int trailing_zeros() const { return mask_ ? countr_zero64(mask_) >> Shift : Width; }
+    int leading_zeros() const {
+        constexpr int extra_bits = 64 - (Width << Shift);
+        return mask_ ? countl_zero64(mask_ << extra_bits) >> Shift : Width;
+    }
+
+private:
+    uint64_t mask_;
+};
+
+#if defined(__AVX2__)
+
+class Group {
+public:
+    static constexpr size_t width = 32;
+    using mask_type = BitMask<32, 0>;
+
+    explicit Group(const ctrl_t* pos)
+        : ctrl_(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos))) {}
+
+    mask_type match(ctrl_t h2) const {
+        return mask_type(static_cast<uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_set1_epi8(h2), ctrl_))));
+    }
+    mask_type match_empty() const {
+        return mask_type(static_cast<uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_set1_epi8(CTRL_EMPTY), ctrl_))));
+    }
+    mask_type match_empty_or_deleted() const {
+        return mask_type(static_cast<uint32_t>(_mm256_movemask_epi8(ctrl_)));
+    }
+    mask_type match_full() const {
+        return mask_type(static_cast<uint32_t>(~_mm256_movemask_epi8(ctrl_)));
+    }
+
+private:
+    __m256i ctrl_;
+};
+
+#elif defined(UNORDERED_MAP_GROUP_SSE2)
+
+class Group {
+public:
+    static constexpr size_t width = 16;
+    using mask_type = BitMask<16, 0>;
+
+    explicit Group(const ctrl_t* pos)
+        : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos))) {}
+
+    mask_type match(ctrl_t h2) const {
+        return mask_type(static_cast<uint32_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_))));
+    }
+    mask_type match_empty() const {
+        return mask_type(static_cast<uint32_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(CTRL_EMPTY), ctrl_))));
+    }
+    mask_type match_empty_or_deleted() const {
+        return mask_type(static_cast<uint32_t>(_mm_movemask_epi8(ctrl_)));
+    }
+    mask_type match_full() const {
+        return mask_type(static_cast<uint32_t>(~_mm_movemask_epi8(ctrl_)) & 0xFFFFu);
+    }
+
+private:
+    __m128i ctrl_;
+};
+
+#elif defined(UNORDERED_MAP_GROUP_NEON)
+
+class Group {
+public:
+    static constexpr size_t width = 16;
+    using mask_type = BitMask<16, 2>;
+
+    explicit Group(const ctrl_t* pos)
+        : ctrl_(vld1q_s8(pos)) {}
+
+    mask_type match(ctrl_t h2) const {
+        return to_mask(vceqq_s8(vdupq_n_s8(h2), ctrl_));
+    }
+    mask_type match_empty() const {
+        return to_mask(vceqq_s8(vdupq_n_s8(CTRL_EMPTY), ctrl_));
+    }
+    mask_type match_empty_or_deleted() const {
+        return to_mask(vcltq_s8(ctrl_, vdupq_n_s8(0)));
+    }
+    mask_type match_full() const {
+        return to_mask(vcgeq_s8(ctrl_, vdupq_n_s8(0)));
+    }
+
+private:
+    // Narrows each 0x00/0xFF lane to a nibble and keeps its top bit.
+    static mask_type to_mask(uint8x16_t lanes) {
+        uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(lanes), 4);
+        return mask_type(vget_lane_u64(vreinterpret_u64_u8(nibbles), 0) & 0x8888888888888888ull);
+    }
+
+    int8x16_t ctrl_;
+};
+
+#else
+
+// Portable fallback: eight control bytes per group, matched with SWAR
+// arithmetic on one 64-bit word.
+class Group {
+public:
+    static constexpr size_t width = 8;
+    using mask_type = BitMask<8, 3>;
+
+    explicit Group(const ctrl_t* pos) {
+        std::memcpy(&ctrl_, pos, sizeof(ctrl_));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        ctrl_ = __builtin_bswap64(ctrl_);
+#endif
+    }
+
+    // May report a false positive for a byte adjacent to a true match; the
+    // caller always confirms with the key comparison.
+    mask_type match(ctrl_t h2) const {
+        constexpr uint64_t lsbs = 0x0101010101010101ull;
+        constexpr uint64_t msbs = 0x8080808080808080ull;
+        uint64_t x = ctrl_ ^ (lsbs * static_cast<uint8_t>(h2));
+        return mask_type((x - lsbs) & ~x & msbs);
+    }
+    mask_type match_empty() const {
+        constexpr uint64_t msbs = 0x8080808080808080ull;
+        return mask_type((ctrl_ & ~(ctrl_ << 6)) & msbs);
+    }
+    mask_type match_empty_or_deleted() const {
+        constexpr uint64_t msbs = 0x8080808080808080ull;
+        return mask_type(ctrl_ & msbs);
+    }
+    mask_type match_full() const {
+        constexpr uint64_t msbs = 0x8080808080808080ull;
+        return mask_type(~ctrl_ & msbs);
+    }
+
+private:
+    uint64_t ctrl_;
+};
+
+#endif
+
+static_assert(Group::width <= sizeof(EMPTY_GROUP), "EMPTY_GROUP must cover one group");
+
+} // namespace detail
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef FLAT_TABLE_HPP
+#define FLAT_TABLE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "chainedTableHeader.hpp"
+#include "controlGroupHeader.hpp"
+#include "indexPoliciesHeader.hpp"
+#include "statsPolicyHeader.hpp"
+#include "threadPoolHeader.hpp"
+
+namespace detail {
+
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+class FlatTable {
+public:
+    using value_type = Value;
+    using size_type = size_t;
+    using position = size_type;
+    using const_position = size_type;
+    using node_list = chain_list<value_type, StoreHash, Allocator>;
+
+    static constexpr float default_max_load_factor = 0.875f;
+    static constexpr bool supports_parallel = true;
+    static size_type max_load(size_type bucket_count, float max_load_factor);
+
+    using allocator_type = Allocator;
+
+    FlatTable(size_type bucket_count, const Allocator& alloc);
+    FlatTable(const FlatTable&) = delete;
+    FlatTable(const FlatTable& other, const Allocator& alloc);
+    FlatTable(FlatTable&& other) noexcept;
+    ~FlatTable();
+
+    FlatTable& operator=(const FlatTable&) = delete;
+    FlatTable& operator=(FlatTable&& other) noexcept;
+
+    allocator_type get_allocator() const;
+    size_type bucket_count() const;
+    size_type bucket_size(size_type i) const;
+    size_type index_for(size_type hash) const;
+    size_type tombstones() const;
+
+    template<typename K, typename Eq>
+    position find(const K& key, size_type hash, const Eq& eq) const;
+    template<typename K, typename Eq>
+    position find(const K& key, size_type hash, const Eq& eq, size_type& probes) const;
+    void prefetch(size_type hash) const;
+    void prefetch_chain(size_type hash) const;
+    template<typename K, typename Eq>
+    size_type probe_length(const K& key, size_type hash, const Eq& eq) const;
+    MemoryUsage memory_usage() const;
+    template<typename... Args>
+    position emplace(size_type hash, Args&&... args);
+    void erase(position pos);
+    void extract(position pos, node_list& into);
+    position insert_node(size_type hash, node_list& from);
+    static const_position to_const(position pos);
+    position to_mutable(const_position pos) const;
+    void clear();
+    template<typename HashOf>
+    void rehash(size_type new_count, const HashOf& hash_of);
+    template<typename HashOf, typename Executor>
+    void rehash(size_type new_count, const HashOf& hash_of, Executor& executor);
+    template<typename HashOf>
+    void reseed(const HashOf& hash_of);
+    template<typename It, typename Eq, typename Executor>
+    void insert_parallel(It first, const size_type* hashes, size_type n, const Eq& eq, Executor& executor,
+                         size_type& inserted, std::vector<size_type>& deferred);
+    void swap(FlatTable& other) noexcept;
+
+    position begin() const;
+    position end() const;
+    size_type segments() const;
+    position seek(size_type segment) const;
+    void next(position& pos) const;
+    template<typename F>
+    void for_each(F& f);
+    template<typename F>
+    void for_each(F& f) const;
+    template<typename F, typename HashOf>
+    void for_each_hashed(F& f, const HashOf& hash_of) const;
+    value_type& value(position pos);
+    const value_type& value(position pos) const;
+
+private:
+    using slot_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<value_type>;
+    using alloc_traits = std::allocator_traits<slot_allocator>;
+    using hash_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<size_type>;
+    using hash_alloc_traits = std::allocator_traits<hash_allocator>;
+    using ctrl_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<ctrl_t>;
+    using ctrl_alloc_traits = std::allocator_traits<ctrl_allocator>;
+
+    // Fewest slots a task of a parallel rehash or insert fills. Elements
+    // whose probe runs off the end of a region are placed afterwards, one
+    // by one, so regions must be long next to a typical probe.
+    static constexpr size_type PARALLEL_REGION = 4096;
+
+    static ctrl_t* empty_ctrl();
+    static size_type mix(size_type hash);
+    static ctrl_t h2(size_type mixed);
+    static bool is_full(ctrl_t c);
+    static size_type ctrl_bytes(size_type capacity);
+    size_type home(size_type mixed) const;
+    void set_ctrl(size_type i, ctrl_t c);
+    template<typename... Args>
+    void construct_at(size_type i, size_type hash, size_type mixed, Args&&... args);
+    size_type find_free(size_type mixed) const;
+    template<typename HashOf>
+    void drop_deleted(const HashOf& hash_of);
+    size_type next_full(size_type from) const;
+
+    slot_allocator alloc_;
+    // capacity_ control bytes followed by clones of the first
+    // Group::width - 1, so a group load never has to wrap around;
+    // EMPTY_GROUP when capacity_ is zero.
+    ctrl_t* ctrl_;
+    value_type* slots_;
+    // Full hash of each slot's element; only allocated when StoreHash is set.
+    size_type* hashes_;
+    size_type capacity_;
+    size_type deleted_;
+    // Lowest full slot, or capacity_ when the table is empty.
+    size_type first_;
+};
+
+} // namespace detail
+
+struct FlatStorage {
+    template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+    using table = detail::FlatTable<Value, IndexPolicy, StoreHash, Allocator>;
+};
+
+#include "flatTableImplementation.tpp"
+
+#endif
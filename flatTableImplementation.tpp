@@ -0,0 +1,885 @@
+#include "flatTableHeader.hpp"
+
+namespace detail {
+
+//******************************************************************************
+//* @brief Returns the largest number of occupied slots allowed for the given *
+//* capacity. At least one slot always stays empty so that every probe     *
+//* sequence terminates.                                                *
+//* *
+//* @param bucket_count    The number of slots.                               *
+//* @param max_load_factor The maximum fraction of occupied slots.            *
+//* @return The occupancy limit for that capacity.                           *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename FlatTable<Value, IndexPolicy, StoreHash, Allocator>::size_type
+FlatTable<Value, IndexPolicy, StoreHash, Allocator>::max_load(size_type bucket_count, float max_load_factor) {
+    if (bucket_count == 0) return 0;
+    size_type limit = static_cast<size_type>(bucket_count * max_load_factor);
+    return limit < bucket_count ? limit : bucket_count - 1;
+}
+
+//******************************************************************************
+//* @brief Constructs a table of empty slots. Non-zero capacities are rounded *
+//* up to one full group so that a probe never sees the same slot twice.  *
+//* A table with no slots allocates nothing: its control bytes are the  *
+//* shared EMPTY_GROUP, so lookups still find an empty group and stop.  *
+//* *
+//* @param bucket_count The number of slots to allocate.                     *
+//* @param alloc        The allocator to draw the slot, hash and control     *
+//* arrays from.                                            *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+FlatTable<Value, IndexPolicy, StoreHash, Allocator>::FlatTable(size_type bucket_count, const Allocator& alloc)
+    : alloc_(alloc), ctrl_(empty_ctrl()), slots_(nullptr), hashes_(nullptr),
+      capacity_(bucket_count == 0 || bucket_count >= Group::width ? bucket_count : Group::width),
+      deleted_(0), first_(capacity_) {
+    if (capacity_ == 0) return;
+    ctrl_allocator ctrl_alloc(alloc_);
+    ctrl_ = ctrl_alloc_traits::allocate(ctrl_alloc, ctrl_bytes(capacity_));
+    std::fill(ctrl_, ctrl_ + ctrl_bytes(capacity_), CTRL_EMPTY);
+    slots_ = alloc_traits::allocate(alloc_, capacity_);
+    if (StoreHash) {
+        hash_allocator hash_alloc(alloc_);
+        hashes_ = hash_alloc_traits::allocate(hash_alloc, capacity_);
+    }
+}
+
+//******************************************************************************
+//* @brief Clone constructor. Reproduces the slot layout of other exactly:  *
+//* every element lands in the same slot with the same control byte and *
+//* stored hash, so nothing is hashed, probed or compared. Trivially    *
+//* copyable elements are copied with one memcpy per array.            *
+//* *
+//* @param other The table to copy.                                          *
+//* @param alloc The allocator for the new arrays.                           *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+FlatTable<Value, IndexPolicy, StoreHash, Allocator>::FlatTable(const FlatTable& other, const Allocator& alloc)
+    : FlatTable(other.capacity_, alloc) {
+    if (capacity_ == 0) return;
+    if (StoreHash) std::memcpy(hashes_, other.hashes_, capacity_ * sizeof(size_type));
+    if constexpr (std::is_trivially_copy_constructible<value_type>::value &&
+                  std::is_trivially_destructible<value_type>::value) {
+        std::memcpy(static_cast<void*>(slots_), other.slots_, capacity_ * sizeof(value_type));
+        std::memcpy(ctrl_, other.ctrl_, ctrl_bytes(capacity_));
+        first_ = other.first_;
+    } else {
+        // A control byte is published only once its slot is constructed, so
+        // if a copy throws the destructor sees exactly the finished slots.
+        for (size_type i = 0; i < capacity_; ++i) {
+            if (is_full(other.ctrl_[i])) {
+                alloc_traits::construct(alloc_, slots_ + i, other.slots_[i]);
+                set_ctrl(i, other.ctrl_[i]);
+                if (i < first_) first_ = i;
+            } else if (other.ctrl_[i] == CTRL_DELETED) {
+                set_ctrl(i, CTRL_DELETED);
+            }
+        }
+    }
+    deleted_ = other.deleted_;
+}
+
+//******************************************************************************
+//* @brief Move constructor. Takes over the slot array of another table and   *
+//* leaves it with no slots.                                             *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+FlatTable<Value, IndexPolicy, StoreHash, Allocator>::FlatTable(FlatTable&& other) noexcept
+    : alloc_(other.alloc_), ctrl_(other.ctrl_),
+      slots_(other.slots_), hashes_(other.hashes_), capacity_(other.capacity_), deleted_(other.deleted_),
+      first_(other.first_) {
+    other.ctrl_ = empty_ctrl();
+    other.slots_ = nullptr;
+    other.hashes_ = nullptr;
+    other.capacity_ = 0;
+    other.deleted_ = 0;
+    other.first_ = 0;
+}
+
+//******************************************************************************
+//* @brief Destructor. Destroys every element and releases the slot array.   *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+FlatTable<Value, IndexPolicy, StoreHash, Allocator>::~FlatTable() {
+    clear();
+    if (slots_) alloc_traits::deallocate(alloc_, slots_, capacity_);
+    if (hashes_) {
+        hash_allocator hash_alloc(alloc_);
+        hash_alloc_traits::deallocate(hash_alloc, hashes_, capacity_);
+    }
+    if (capacity_ != 0) {
+        ctrl_allocator ctrl_alloc(alloc_);
+        ctrl_alloc_traits::deallocate(ctrl_alloc, ctrl_, ctrl_bytes(capacity_));
+    }
+}
+
+//******************************************************************************
+//* @brief Move assignment operator. Releases this table's slots and takes   *
+//* over those of another table.                                          *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+FlatTable<Value, IndexPolicy, StoreHash, Allocator>& FlatTable<Value, IndexPolicy, StoreHash, Allocator>::operator=(FlatTable&& other) noexcept {
+    if (this != &other) {
+        FlatTable tmp(std::move(other));
+        swap(tmp);
+    }
+    return *this;
+}
+
+//******************************************************************************
+//* @brief Returns a copy of the allocator the table was constructed with.   *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename FlatTable<Value, IndexPolicy, StoreHash, Allocator>::allocator_type
+FlatTable<Value, IndexPolicy, StoreHash, Allocator>::get_allocator() const {
+    return allocator_type(alloc_);
+}
+
+//******************************************************************************
+//* @brief Returns the number of slots.                                       *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename FlatTable<Value, IndexPolicy, StoreHash, Allocator>::size_type FlatTable<Value, IndexPolicy, StoreHash, Allocator>::bucket_count() const {
+    return capacity_;
+}
+
+//******************************************************************************
+//* @brief Returns 1 if slot i holds an element, 0 otherwise.                *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename FlatTable<Value, IndexPolicy, StoreHash, Allocator>::size_type FlatTable<Value, IndexPolicy, StoreHash, Allocator>::bucket_size(size_type i) const {
+    return is_full(ctrl_[i]) ? 1 : 0;
+}
+
+//******************************************************************************
+//* @brief Maps a hash value to the slot where its probe sequence starts: *
+//* the index policy's reduction of the mixed hash.                     *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename FlatTable<Value, IndexPolicy, StoreHash, Allocator>::size_type FlatTable<Value, IndexPolicy, StoreHash, Allocator>::index_for(size_type hash) const {
+    return home(mix(hash));
+}
+
+//******************************************************************************
+//* @brief Returns the number of slots marked deleted. They still count       *
+//* towards the occupancy limit until the next rehash reclaims them.     *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename FlatTable<Value, IndexPolicy, StoreHash, Allocator>::size_type FlatTable<Value, IndexPolicy, StoreHash, Allocator>::tombstones() const {
+    return deleted_;
+}
+
+//******************************************************************************
+//* @brief Looks up a key one group of slots at a time. Each group's control  *
+//* bytes are compared against the key's 7-bit tag in a single SIMD        *
+//* operation, and only tag matches reach the key equality predicate —    *
+//* after a full-hash comparison when hashes are stored. The probe stops  *
+//* at the first group that contains an empty slot.                       *
+//* *
+//* @param key  The key to search for.                                        *
+//* @param hash The hash of the key.                                          *
+//* @param eq   The key equality predicate.                                   *
+//* @return The slot holding the matching element, or end().                 *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename K, typename Eq>
+typename FlatTable<Value, IndexPolicy, StoreHash, Allocator>::position
+FlatTable<Value, IndexPolicy, StoreHash, Allocator>::find(const K& key, size_type hash, const Eq& eq) const {
+    size_type mixed = mix(hash);
+    size_type pos = home(mixed);
+    ctrl_t tag = h2(mixed);
+    while (true) {
+        Group group(ctrl_ + pos);
+        for (auto match = group.match(tag); match; match.clear_lowest()) {
+            size_type i = pos + match.lowest();
+            if (i >= capacity_) i -= capacity_;
+            if ((!StoreHash || hashes_[i] == hash) && eq(slots_[i].first, key)) return i;
+        }
+        if (group.match_empty()) return end();
+        pos += Group::width;
+        if (pos >= capacity_) pos -= capacity_;
+    }
+}
+
+//******************************************************************************
+//* @brief Looks up a key like find() and also counts the control groups  *
+//* loaded, as probe_length() reports them, so that a caller needing    *
+//* both probes once.                                                   *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename K, typename Eq>
+typename FlatTable<Value, IndexPolicy, StoreHash, Allocator>::position
+FlatTable<Value, IndexPolicy, StoreHash, Allocator>::find(const K& key, size_type hash, const Eq& eq, size_type& probes) const {
+    probes = 0;
+    if (capacity_ == 0) return end();
+    size_type mixed = mix(hash);
+    size_type pos = home(mixed);
+    ctrl_t tag = h2(mixed);
+    while (true) {
+        ++probes;
+        Group group(ctrl_ + pos);
+        for (auto match = group.match(tag); match; match.clear_lowest()) {
+            size_type i = pos + match.lowest();
+            if (i >= capacity_) i -= capacity_;
+            if ((!StoreHash || hashes_[i] == hash) && eq(slots_[i].first, key)) return i;
+        }
+        if (group.match_empty()) return end();
+        pos += Group::width;
+        if (pos >= capacity_) pos -= capacity_;
+    }
+}
+
+//******************************************************************************
+//* @brief Starts loading the first control group, slot and stored hash of a *
+//* hash's probe sequence into the cache.                              *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void FlatTable<Value, IndexPolicy, StoreHash, Allocator>::prefetch(size_type hash) const {
+    size_type pos = home(mix(hash));
+    detail::prefetch(ctrl_ + pos);
+    detail::prefetch(slots_ + pos);
+    if (StoreHash) detail::prefetch(hashes_ + pos);
+}
+
+//******************************************************************************
+//* @brief Does nothing: prefetch() already reaches every line a probe needs *
+//* first, since slots hold elements inline.                            *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void FlatTable<Value, IndexPolicy, StoreHash, Allocator>::prefetch_chain(size_type) const {}
+
+//******************************************************************************
+//* @brief Counts the control groups a lookup for key loads, up to the one  *
+//* holding the key or the first with an empty slot.                   *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename K, typename Eq>
+typename FlatTable<Value, IndexPolicy, StoreHash, Allocator>::size_type
+FlatTable<Value, IndexPolicy, StoreHash, Allocator>::probe_length(const K& key, size_type hash, const Eq& eq) const {
+    size_type probes;
+    find(key, hash, eq, probes);
+    return probes;
+}
+
+//******************************************************************************
+//* @brief Reports the memory held by the control, slot and hash arrays.    *
+//* Elements live in the slots, so there are no nodes.                  *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+MemoryUsage FlatTable<Value, IndexPolicy, StoreHash, Allocator>::memory_usage() const {
+    MemoryUsage usage;
+    if (capacity_ == 0) return usage;
+    usage.table = ctrl_bytes(capacity_) + capacity_ * sizeof(value_type) + (StoreHash ? capacity_ * sizeof(size_type) : 0);
+    usage.allocations = StoreHash ? 3 : 2;
+    return usage;
+}
+
+//******************************************************************************
+//* @brief Constructs a new element in the first free slot of its probe       *
+//* sequence, reusing a deleted slot when one comes first. The caller     *
+//* guarantees that the key is not already present and that the table has *
+//* room for one more element.                                          *
+//* *
+//* @param hash The hash of the new element's key.                           *
+//* @param args Arguments forwarded to the value_type constructor.           *
+//* @return The slot of the new element.                                     *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename... Args>
+typename FlatTable<Value, IndexPolicy, StoreHash, Allocator>::position
+FlatTable<Value, IndexPolicy, StoreHash, Allocator>::emplace(size_type hash, Args&&... args) {
+    size_type mixed = mix(hash);
+    size_type i = find_free(mixed);
+    if (ctrl_[i] == CTRL_DELETED) --deleted_;
+    construct_at(i, hash, mixed, std::forward<Args>(args)...);
+    if (i < first_) first_ = i;
+    return i;
+}
+
+//******************************************************************************
+//* @brief Destroys the element in a slot. The slot can become empty again    *
+//* only if no probe ever saw a full group around it: when the run of     *
+//* non-empty slots through it is shorter than a group, every group that  *
+//* contains it also holds an empty slot that would have ended the probe. *
+//* Otherwise it is marked deleted.                                      *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void FlatTable<Value, IndexPolicy, StoreHash, Allocator>::erase(position pos) {
+    alloc_traits::destroy(alloc_, slots_ + pos);
+    size_type before = pos >= Group::width ? pos - Group::width : pos + capacity_ - Group::width;
+    auto empty_after = Group(ctrl_ + pos).match_empty();
+    auto empty_before = Group(ctrl_ + before).match_empty();
+    bool was_never_full = empty_before && empty_after &&
+        static_cast<size_type>(empty_after.trailing_zeros() + empty_before.leading_zeros()) < Group::width;
+    if (was_never_full) {
+        set_ctrl(pos, CTRL_EMPTY);
+    } else {
+        set_ctrl(pos, CTRL_DELETED);
+        ++deleted_;
+    }
+    if (pos == first_) first_ = next_full(pos + 1);
+}
+
+
+//******************************************************************************
+//* @brief Moves the element in a slot into a new node at the end of a     *
+//* list, then frees the slot.                                          *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void FlatTable<Value, IndexPolicy, StoreHash, Allocator>::extract(position pos, node_list& into) {
+    into.emplace_back(StoreHash ? hashes_[pos] : 0, std::move(slots_[pos]));
+    erase(pos);
+}
+
+//******************************************************************************
+//* @brief Moves the element of the first node of a list into a free slot  *
+//* and frees the node. The caller guarantees that the key is not       *
+//* already present.                                                    *
+//* *
+//* @param hash The hash of the node's key.                                  *
+//* @param from The list to take the node from; must not be empty.          *
+//* @return The position of the inserted element.                           *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename FlatTable<Value, IndexPolicy, StoreHash, Allocator>::position FlatTable<Value, IndexPolicy, StoreHash, Allocator>::insert_node(size_type hash, node_list& from) {
+    position pos = emplace(hash, std::move(from.front().value));
+    from.pop_front();
+    return pos;
+}
+
+//******************************************************************************
+//* @brief Converts a position to its read-only form. Both are slot indices. *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename FlatTable<Value, IndexPolicy, StoreHash, Allocator>::const_position
+FlatTable<Value, IndexPolicy, StoreHash, Allocator>::to_const(position pos) {
+    return pos;
+}
+
+//******************************************************************************
+//* @brief Converts a read-only position back to a mutable one.              *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename FlatTable<Value, IndexPolicy, StoreHash, Allocator>::position
+FlatTable<Value, IndexPolicy, StoreHash, Allocator>::to_mutable(const_position pos) const {
+    return pos;
+}
+
+//******************************************************************************
+//* @brief Destroys every element and marks all slots empty.                  *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void FlatTable<Value, IndexPolicy, StoreHash, Allocator>::clear() {
+    for (size_type i = 0; i < capacity_; ++i) {
+        if (is_full(ctrl_[i])) alloc_traits::destroy(alloc_, slots_ + i);
+    }
+    if (capacity_ != 0) std::fill(ctrl_, ctrl_ + ctrl_bytes(capacity_), CTRL_EMPTY);
+    deleted_ = 0;
+    first_ = capacity_;
+}
+
+//******************************************************************************
+//* @brief Moves all elements into a new slot array, dropping tombstones.    *
+//* Keys are copied rather than moved because value_type holds them as     *
+//* const; mapped values are moved. A rehash to the current capacity     *
+//* only has tombstones to reclaim, and does so in place.               *
+//* *
+//* @param new_count The new number of slots.                                *
+//* @param hash_of   Returns the hash of an element; unused when hashes are  *
+//* stored.                                                 *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename HashOf>
+void FlatTable<Value, IndexPolicy, StoreHash, Allocator>::rehash(size_type new_count, const HashOf& hash_of) {
+    if (new_count == capacity_ && capacity_ != 0) {
+        drop_deleted(hash_of);
+        return;
+    }
+    FlatTable fresh(new_count, get_allocator());
+    for (size_type i = 0; i < capacity_; ++i) {
+        if (is_full(ctrl_[i]))
+            fresh.emplace(StoreHash ? hashes_[i] : hash_of(slots_[i]), std::move(slots_[i]));
+    }
+    swap(fresh);
+}
+
+//******************************************************************************
+//* @brief Recomputes every hash after the hash function changed and moves *
+//* the elements to their new probe positions in place, reclaiming      *
+//* tombstones on the way. Allocates nothing; hash_of must not throw.   *
+//* *
+//* @param hash_of Returns the new hash of an element.                     *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename HashOf>
+void FlatTable<Value, IndexPolicy, StoreHash, Allocator>::reseed(const HashOf& hash_of) {
+    if (capacity_ == 0) return;
+    if constexpr (StoreHash) {
+        for (size_type i = 0; i < capacity_; ++i) {
+            if (is_full(ctrl_[i])) hashes_[i] = hash_of(slots_[i]);
+        }
+    }
+    drop_deleted(hash_of);
+}
+
+//******************************************************************************
+//* @brief Moves all elements into a new slot array using an executor. The  *
+//* new array is split into regions and the elements are grouped by the *
+//* region their probe starts in; one task per region then places its  *
+//* elements at the first empty slot inside the region, touching no     *
+//* other region's slots. The few elements whose probe would cross the *
+//* end of their region are placed serially afterwards. Tables too small *
+//* to split, and rehashes to the current capacity, use the serial path.*
+//* *
+//* @param new_count The new number of slots.                                *
+//* @param hash_of   Returns the hash of an element; called in parallel, and *
+//* unused when hashes are stored.                          *
+//* @param executor  Runs the tasks; see ThreadPool.                         *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename HashOf, typename Executor>
+void FlatTable<Value, IndexPolicy, StoreHash, Allocator>::rehash(size_type new_count, const HashOf& hash_of, Executor& executor) {
+    size_type region = detail::region_length(new_count, 4 * executor.concurrency(), PARALLEL_REGION, 1);
+    if (region == new_count || (new_count == capacity_ && capacity_ != 0)) {
+        rehash(new_count, hash_of);
+        return;
+    }
+    size_type regions = (new_count + region - 1) / region;
+    FlatTable fresh(new_count, get_allocator());
+    std::vector<size_type> hashes(StoreHash ? 0 : capacity_);
+    detail::RegionPartition partition(executor, capacity_, regions, [&](size_type i) {
+        if (!is_full(ctrl_[i])) return regions;
+        size_type hash = StoreHash ? hashes_[i] : hash_of(slots_[i]);
+        if (!StoreHash) hashes[i] = hash;
+        return fresh.home(mix(hash)) / region;
+    });
+    auto hash_at = [&](size_type i) { return StoreHash ? hashes_[i] : hashes[i]; };
+
+    std::vector<size_type> overflow_begin(regions + 1, 0);
+    for (size_type r = 0; r < regions; ++r) overflow_begin[r + 1] = overflow_begin[r] + partition.size(r);
+    std::vector<size_type> overflow(overflow_begin[regions]);
+    std::vector<size_type> overflow_count(regions, 0);
+    executor.run(regions, [&](size_t r) {
+        size_type hi = std::min((r + 1) * region, new_count);
+        partition.for_each(r, [&](size_type i) {
+            size_type mixed = mix(hash_at(i));
+            size_type s = fresh.home(mixed);
+            while (s < hi && fresh.ctrl_[s] != CTRL_EMPTY) ++s;
+            if (s == hi) {
+                overflow[overflow_begin[r] + overflow_count[r]++] = i;
+            } else {
+                fresh.construct_at(s, hash_at(i), mixed, std::move(slots_[i]));
+            }
+        });
+    });
+    for (size_type r = 0; r < regions; ++r) {
+        for (size_type k = 0; k < overflow_count[r]; ++k) {
+            size_type i = overflow[overflow_begin[r] + k];
+            fresh.emplace(hash_at(i), std::move(slots_[i]));
+        }
+    }
+    fresh.first_ = fresh.next_full(0);
+    swap(fresh);
+}
+
+//******************************************************************************
+//* @brief Inserts a batch of elements using an executor, in the same      *
+//* regions as the parallel rehash. A task probes for each key group by *
+//* group like find() and otherwise places the element in the first   *
+//* empty slot it saw; both happen inside the task's region. Keys whose *
+//* probe would cross the region's end are left for the caller to      *
+//* insert one by one. Items of a region are handled in input order, so *
+//* of several equal keys the first one wins, as with insert(). The     *
+//* caller must have made room for all n elements.                      *
+//* *
+//* @param first    The first item; item i is *(first + i).                 *
+//* @param hashes   The hash of each item's key.                            *
+//* @param n        The number of items.                                     *
+//* @param eq       The key equality predicate.                             *
+//* @param executor Runs the tasks; see ThreadPool.                          *
+//* @param inserted Set to the number of elements inserted, also when a    *
+//* task throws.                                              *
+//* @param deferred Receives the indices of the items left to the caller, *
+//* in input order per region.                                 *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename It, typename Eq, typename Executor>
+void FlatTable<Value, IndexPolicy, StoreHash, Allocator>::insert_parallel(It first, const size_type* hashes, size_type n, const Eq& eq,
+                                                                         Executor& executor, size_type& inserted,
+                                                                         std::vector<size_type>& deferred) {
+    inserted = 0;
+    size_type region = detail::region_length(capacity_, 4 * executor.concurrency(), PARALLEL_REGION, 1);
+    if (region == capacity_) {
+        for (size_type i = 0; i < n; ++i) deferred.push_back(i);
+        return;
+    }
+    size_type regions = (capacity_ + region - 1) / region;
+    detail::RegionPartition partition(executor, n, regions, [&](size_type i) {
+        return home(mix(hashes[i])) / region;
+    });
+
+    std::vector<size_type> overflow_begin(regions + 1, 0);
+    for (size_type r = 0; r < regions; ++r) overflow_begin[r + 1] = overflow_begin[r] + partition.size(r);
+    std::vector<size_type> overflow(overflow_begin[regions]);
+    std::vector<size_type> overflow_count(regions, 0);
+    std::vector<size_type> counts(regions, 0);
+    auto fill = [&](size_t r) {
+        size_type hi = std::min((r + 1) * region, capacity_);
+        partition.for_each(r, [&](size_type i) {
+            const auto& item = *(first + i);
+            size_type hash = hashes[i];
+            size_type mixed = mix(hash);
+            ctrl_t tag = h2(mixed);
+            size_type free = hi;
+            // The same groups find() would probe, read a byte at a time so
+            // that nothing past hi is touched.
+            for (size_type pos = home(mixed);; pos += Group::width) {
+                if (pos + Group::width > hi) {
+                    overflow[overflow_begin[r] + overflow_count[r]++] = i;
+                    return;
+                }
+                for (size_type s = pos; s < pos + Group::width; ++s) {
+                    if (ctrl_[s] == CTRL_EMPTY) {
+                        if (free == hi) free = s;
+                    } else if (ctrl_[s] == tag && (!StoreHash || hashes_[s] == hash) && eq(slots_[s].first, item.first)) {
+                        return;
+                    }
+                }
+                if (free != hi) break;
+            }
+            construct_at(free, hash, mixed, item);
+            ++counts[r];
+        });
+    };
+    auto finish = [&] {
+        for (size_type r = 0; r < regions; ++r) inserted += counts[r];
+        first_ = next_full(0);
+    };
+    try {
+        executor.run(regions, fill);
+    } catch (...) {
+        finish();
+        throw;
+    }
+    finish();
+    for (size_type r = 0; r < regions; ++r) {
+        deferred.insert(deferred.end(), overflow.begin() + overflow_begin[r],
+                        overflow.begin() + overflow_begin[r] + overflow_count[r]);
+    }
+}
+
+//******************************************************************************
+//* @brief Exchanges the slots of two tables.                                 *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void FlatTable<Value, IndexPolicy, StoreHash, Allocator>::swap(FlatTable& other) noexcept {
+    using std::swap;
+    // As with the standard containers, allocators that do not propagate on
+    // swap must compare equal, and then there is nothing to exchange.
+    if constexpr (alloc_traits::propagate_on_container_swap::value) {
+        swap(alloc_, other.alloc_);
+    }
+    swap(ctrl_, other.ctrl_);
+    swap(slots_, other.slots_);
+    swap(hashes_, other.hashes_);
+    swap(capacity_, other.capacity_);
+    swap(deleted_, other.deleted_);
+    swap(first_, other.first_);
+}
+
+//******************************************************************************
+//* @brief Returns the first occupied slot, or end() if the table is empty.  *
+//* The slot is tracked on every insertion and erasure, so this is O(1).*
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename FlatTable<Value, IndexPolicy, StoreHash, Allocator>::position FlatTable<Value, IndexPolicy, StoreHash, Allocator>::begin() const {
+    return first_;
+}
+
+//******************************************************************************
+//* @brief Returns the past-the-end slot index.                              *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename FlatTable<Value, IndexPolicy, StoreHash, Allocator>::position FlatTable<Value, IndexPolicy, StoreHash, Allocator>::end() const {
+    return capacity_;
+}
+
+//******************************************************************************
+//* @brief Returns the number of segments iteration can be split at: one  *
+//* per slot.                                                           *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename FlatTable<Value, IndexPolicy, StoreHash, Allocator>::size_type FlatTable<Value, IndexPolicy, StoreHash, Allocator>::segments() const {
+    return capacity_;
+}
+
+//******************************************************************************
+//* @brief Returns the first full slot at index segment or later, or end(). *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename FlatTable<Value, IndexPolicy, StoreHash, Allocator>::position FlatTable<Value, IndexPolicy, StoreHash, Allocator>::seek(size_type segment) const {
+    return next_full(segment);
+}
+
+//******************************************************************************
+//* @brief Moves a position to the next occupied slot.                       *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void FlatTable<Value, IndexPolicy, StoreHash, Allocator>::next(position& pos) const {
+    if (pos >= capacity_) return;
+    pos = next_full(pos + 1);
+}
+
+//******************************************************************************
+//* @brief Calls f on every element, one group of control bytes at a time.   *
+//* The loop has no iterator state to carry, so the compiler sees a plain *
+//* scan over the control and slot arrays.                               *
+//* *
+//* @param f The function to call with each element.                        *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename F>
+void FlatTable<Value, IndexPolicy, StoreHash, Allocator>::for_each(F& f) {
+    for (size_type base = first_; base < capacity_; base += Group::width) {
+        for (auto full = Group(ctrl_ + base).match_full(); full; full.clear_lowest()) {
+            size_type i = base + full.lowest();
+            if (i >= capacity_) return;
+            f(slots_[i]);
+        }
+    }
+}
+
+//******************************************************************************
+//* @brief Calls f on every element (const version).                         *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename F>
+void FlatTable<Value, IndexPolicy, StoreHash, Allocator>::for_each(F& f) const {
+    for (size_type base = first_; base < capacity_; base += Group::width) {
+        for (auto full = Group(ctrl_ + base).match_full(); full; full.clear_lowest()) {
+            size_type i = base + full.lowest();
+            if (i >= capacity_) return;
+            f(static_cast<const value_type&>(slots_[i]));
+        }
+    }
+}
+
+//******************************************************************************
+//* @brief Calls f(element, hash) on every element, taking the hash from   *
+//* the hash array when hashes are stored and from hash_of otherwise.   *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename F, typename HashOf>
+void FlatTable<Value, IndexPolicy, StoreHash, Allocator>::for_each_hashed(F& f, const HashOf& hash_of) const {
+    for (size_type base = first_; base < capacity_; base += Group::width) {
+        for (auto full = Group(ctrl_ + base).match_full(); full; full.clear_lowest()) {
+            size_type i = base + full.lowest();
+            if (i >= capacity_) return;
+            const value_type& value = slots_[i];
+            f(value, StoreHash ? hashes_[i] : static_cast<size_type>(hash_of(value)));
+        }
+    }
+}
+
+//******************************************************************************
+//* @brief Returns the element stored in a slot.                             *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename FlatTable<Value, IndexPolicy, StoreHash, Allocator>::value_type& FlatTable<Value, IndexPolicy, StoreHash, Allocator>::value(position pos) {
+    return slots_[pos];
+}
+
+//******************************************************************************
+//* @brief Returns the element stored in a slot (const version).             *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+const typename FlatTable<Value, IndexPolicy, StoreHash, Allocator>::value_type& FlatTable<Value, IndexPolicy, StoreHash, Allocator>::value(position pos) const {
+    return slots_[pos];
+}
+
+//******************************************************************************
+//* @brief Mixes a hash before it picks a home slot or a tag. Every policy *
+//* goes through mix_hash here, whatever its own mix() does: linear     *
+//* probing turns the runs of neighbouring home slots that identity     *
+//* hashes such as std::hash<int> produce into clusters that every     *
+//* later probe through them has to walk.                               *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename FlatTable<Value, IndexPolicy, StoreHash, Allocator>::size_type FlatTable<Value, IndexPolicy, StoreHash, Allocator>::mix(size_type hash) {
+    return detail::mix_hash(hash);
+}
+
+//******************************************************************************
+//* @brief Returns the 7-bit tag stored in the control byte of a full slot.  *
+//* It is taken from the end of the mixed hash that the index policy does *
+//* not use to pick the home slot, so that tags stay independent of       *
+//* position.                                                           *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+ctrl_t FlatTable<Value, IndexPolicy, StoreHash, Allocator>::h2(size_type mixed) {
+    if (IndexPolicy::high_bits_index) return static_cast<ctrl_t>(mixed & 0x7F);
+    return static_cast<ctrl_t>(mixed >> (sizeof(size_type) * 8 - 7));
+}
+
+//******************************************************************************
+//* @brief Returns true if a control byte marks a slot holding an element.    *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+bool FlatTable<Value, IndexPolicy, StoreHash, Allocator>::is_full(ctrl_t c) {
+    return c >= 0;
+}
+
+//******************************************************************************
+//* @brief Returns the control bytes of a table with no slots.              *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+ctrl_t* FlatTable<Value, IndexPolicy, StoreHash, Allocator>::empty_ctrl() {
+    return const_cast<ctrl_t*>(EMPTY_GROUP);
+}
+
+//******************************************************************************
+//* @brief Returns the slot where the probe sequence of a mixed hash starts. *
+//* A table with no slots is indexed as if it had one, which lands on  *
+//* EMPTY_GROUP; the adjustment is arithmetic, not a branch.            *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename FlatTable<Value, IndexPolicy, StoreHash, Allocator>::size_type
+FlatTable<Value, IndexPolicy, StoreHash, Allocator>::home(size_type mixed) const {
+    return IndexPolicy::index(mixed, capacity_ + (capacity_ == 0));
+}
+
+//******************************************************************************
+//* @brief Returns the size of the control array for a capacity: one byte   *
+//* per slot plus the cloned tail.                                      *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename FlatTable<Value, IndexPolicy, StoreHash, Allocator>::size_type
+FlatTable<Value, IndexPolicy, StoreHash, Allocator>::ctrl_bytes(size_type capacity) {
+    return capacity + Group::width - 1;
+}
+
+//******************************************************************************
+//* @brief Writes a control byte, mirroring it into the cloned tail when the  *
+//* slot is one of the first Group::width - 1.                           *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void FlatTable<Value, IndexPolicy, StoreHash, Allocator>::set_ctrl(size_type i, ctrl_t c) {
+    ctrl_[i] = c;
+    if (i < Group::width - 1) ctrl_[capacity_ + i] = c;
+}
+
+//******************************************************************************
+//* @brief Constructs an element in slot i and publishes its control byte.  *
+//* Leaves first_ and deleted_ to the caller, so that tasks filling     *
+//* disjoint regions can call it at the same time.                      *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename... Args>
+void FlatTable<Value, IndexPolicy, StoreHash, Allocator>::construct_at(size_type i, size_type hash, size_type mixed, Args&&... args) {
+    alloc_traits::construct(alloc_, slots_ + i, std::forward<Args>(args)...);
+    if (StoreHash) hashes_[i] = hash;
+    set_ctrl(i, h2(mixed));
+}
+
+//******************************************************************************
+//* @brief Returns the first full slot at or after from, or capacity_. Whole *
+//* groups of empty or deleted slots are skipped with one mask test.     *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename FlatTable<Value, IndexPolicy, StoreHash, Allocator>::size_type FlatTable<Value, IndexPolicy, StoreHash, Allocator>::next_full(size_type from) const {
+    for (; from < capacity_; from += Group::width) {
+        auto full = Group(ctrl_ + from).match_full();
+        if (full) {
+            size_type i = from + full.lowest();
+            return i < capacity_ ? i : capacity_;
+        }
+    }
+    return capacity_;
+}
+
+//******************************************************************************
+//* @brief Returns the first empty or deleted slot in the probe sequence of a *
+//* mixed hash.                                                         *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename FlatTable<Value, IndexPolicy, StoreHash, Allocator>::size_type FlatTable<Value, IndexPolicy, StoreHash, Allocator>::find_free(size_type mixed) const {
+    size_type pos = home(mixed);
+    while (true) {
+        auto free = Group(ctrl_ + pos).match_empty_or_deleted();
+        if (free) {
+            size_type i = pos + free.lowest();
+            return i >= capacity_ ? i - capacity_ : i;
+        }
+        pos += Group::width;
+        if (pos >= capacity_) pos -= capacity_;
+    }
+}
+
+//******************************************************************************
+//* @brief Reclaims every tombstone without allocating. Deleted slots become *
+//* empty and full ones are marked deleted, meaning "not yet placed". Each *
+//* marked element is then probed for again: it stays put if its slot is  *
+//* in the first group with room, moves if that group has an empty slot,  *
+//* and otherwise trades places with the marked element found there, which *
+//* is placed next. Every step settles one element, so the pass is O(n). *
+//* *
+//* @param hash_of Returns the hash of an element; unused when hashes are    *
+//* stored.                                                   *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename HashOf>
+void FlatTable<Value, IndexPolicy, StoreHash, Allocator>::drop_deleted(const HashOf& hash_of) {
+    for (size_type i = 0; i < capacity_; ++i) {
+        if (ctrl_[i] == CTRL_DELETED) ctrl_[i] = CTRL_EMPTY;
+        else if (is_full(ctrl_[i])) ctrl_[i] = CTRL_DELETED;
+    }
+    std::copy(ctrl_, ctrl_ + Group::width - 1, ctrl_ + capacity_);
+
+    alignas(value_type) unsigned char spare[sizeof(value_type)];
+    value_type* tmp = reinterpret_cast<value_type*>(spare);
+    size_type i = 0;
+    while (i < capacity_) {
+        if (ctrl_[i] != CTRL_DELETED) {
+            ++i;
+            continue;
+        }
+        size_type hash = StoreHash ? hashes_[i] : hash_of(slots_[i]);
+        size_type mixed = mix(hash);
+        size_type pos = home(mixed);
+        auto free = Group(ctrl_ + pos).match_empty_or_deleted();
+        while (!free) {
+            pos += Group::width;
+            if (pos >= capacity_) pos -= capacity_;
+            free = Group(ctrl_ + pos).match_empty_or_deleted();
+        }
+        if ((i >= pos ? i - pos : i + capacity_ - pos) < Group::width) {
+            set_ctrl(i, h2(mixed));
+            ++i;
+            continue;
+        }
+        size_type target = pos + free.lowest();
+        if (target >= capacity_) target -= capacity_;
+        if (ctrl_[target] == CTRL_EMPTY) {
+            alloc_traits::construct(alloc_, slots_ + target, std::move(slots_[i]));
+            alloc_traits::destroy(alloc_, slots_ + i);
+            if (StoreHash) hashes_[target] = hashes_[i];
+            set_ctrl(target, h2(mixed));
+            set_ctrl(i, CTRL_EMPTY);
+            ++i;
+        } else {
+            alloc_traits::construct(alloc_, tmp, std::move(slots_[target]));
+            alloc_traits::destroy(alloc_, slots_ + target);
+            alloc_traits::construct(alloc_, slots_ + target, std::move(slots_[i]));
+            alloc_traits::destroy(alloc_, slots_ + i);
+            alloc_traits::construct(alloc_, slots_ + i, std::move(*tmp));
+            alloc_traits::destroy(alloc_, tmp);
+            if (StoreHash) std::swap(hashes_[i], hashes_[target]);
+            set_ctrl(target, h2(mixed));
+        }
+    }
+    deleted_ = 0;
+    first_ = next_full(0);
+}
+
+} // namespace detail
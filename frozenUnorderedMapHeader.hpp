@@ -0,0 +1,87 @@
+#ifndef FROZEN_UNORDERED_MAP_HPP
+#define FROZEN_UNORDERED_MAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "snapshotHeader.hpp"
+
+// Read-only map over a snapshot written by UnorderedMap::save(). Opening a
+// file maps it into memory and checks the header and the two ends of the
+// offset table; nothing else is parsed, copied or allocated. Lookups hash
+// the key, read and check the bucket's range in the offset table and scan
+// its records in place, so only the pages a lookup touches are ever read
+// from disk. Results are views into the mapping (the value itself for
+// trivially copyable types, a std::string_view for strings) and stay
+// valid while the map is alive.
+template<
+    typename Key,
+    typename T,
+    typename Hash = std::hash<Key>,
+    typename KeyEqual = std::equal_to<Key>
+>
+class FrozenUnorderedMap {
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using size_type = size_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using key_view = typename serializer<Key>::view_type;
+    using mapped_view = typename serializer<T>::view_type;
+
+    explicit FrozenUnorderedMap(const std::string& path,
+                                const Hash& hash = Hash(),
+                                const KeyEqual& equal = KeyEqual());
+    FrozenUnorderedMap(const void* data, size_type size,
+                       const Hash& hash = Hash(),
+                       const KeyEqual& equal = KeyEqual());
+    FrozenUnorderedMap(const FrozenUnorderedMap&) = delete;
+    FrozenUnorderedMap(FrozenUnorderedMap&& other) noexcept;
+    ~FrozenUnorderedMap();
+
+    FrozenUnorderedMap& operator=(const FrozenUnorderedMap&) = delete;
+    FrozenUnorderedMap& operator=(FrozenUnorderedMap&& other) noexcept;
+
+    std::optional<mapped_view> find(const Key& key) const;
+    bool contains(const Key& key) const;
+    template<class F>
+    void for_each(F&& f) const;
+
+    bool empty() const;
+    size_type size() const;
+    size_type bucket_count() const;
+
+private:
+    void attach(const unsigned char* data, size_type size);
+    void unmap();
+    bool keys_equal(const Key& key, const key_view& stored) const;
+    uint64_t offset(uint64_t bucket) const;
+
+    // The mapping owned by this map, or null when viewing caller memory.
+    void* mapping_;
+    size_type mapping_size_;
+    const unsigned char* offsets_;
+    const unsigned char* records_;
+    uint64_t bucket_bits_;
+    uint64_t element_count_;
+    uint64_t records_size_;
+    Hash hasher_;
+    KeyEqual equal_;
+};
+
+#include "frozenUnorderedMapImplementation.tpp"
+
+#endif
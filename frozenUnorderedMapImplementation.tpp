@@ -0,0 +1,251 @@
+#include "frozenUnorderedMapHeader.hpp"
+
+//******************************************************************************
+//* @brief Maps a snapshot file read-only and validates its header. The    *
+//* rest of the file is not read; its pages are faulted in by the      *
+//* lookups that touch them.                                            *
+//* *
+//* @param path  The snapshot file written by UnorderedMap::save().          *
+//* @param hash  The hash function; must match the one the snapshot was     *
+//* written with.                                              *
+//* @param equal The key equality predicate.                                *
+//* @throws std::runtime_error if the file cannot be mapped or is not a     *
+//* snapshot for these key and value types.                    *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+FrozenUnorderedMap<Key, T, Hash, KeyEqual>::FrozenUnorderedMap(const std::string& path, const Hash& hash, const KeyEqual& equal)
+    : mapping_(nullptr), mapping_size_(0), offsets_(nullptr), records_(nullptr),
+      bucket_bits_(0), element_count_(0), records_size_(0), hasher_(hash), equal_(equal) {
+#if __has_include(<sys/mman.h>)
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) throw std::runtime_error("cannot open snapshot " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        throw std::runtime_error("cannot map snapshot " + path);
+    }
+    void* mapping = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) throw std::runtime_error("cannot map snapshot " + path);
+    mapping_ = mapping;
+    mapping_size_ = static_cast<size_type>(st.st_size);
+    try {
+        attach(static_cast<const unsigned char*>(mapping_), mapping_size_);
+    } catch (...) {
+        unmap();
+        throw;
+    }
+#else
+    throw std::runtime_error("mapping snapshot " + path + " needs POSIX mmap; map it yourself and pass the memory");
+#endif
+}
+
+//******************************************************************************
+//* @brief Views a snapshot that is already in memory, e.g. mapped by the   *
+//* caller or embedded in the binary. The memory is not copied and must *
+//* outlive the map.                                                     *
+//* *
+//* @param data  The first byte of the snapshot.                            *
+//* @param size  The size of the snapshot in bytes.                         *
+//* @param hash  The hash function the snapshot was written with.           *
+//* @param equal The key equality predicate.                                *
+//* @throws std::runtime_error if the memory does not hold a snapshot for   *
+//* these key and value types.                                 *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+FrozenUnorderedMap<Key, T, Hash, KeyEqual>::FrozenUnorderedMap(const void* data, size_type size, const Hash& hash, const KeyEqual& equal)
+    : mapping_(nullptr), mapping_size_(0), offsets_(nullptr), records_(nullptr),
+      bucket_bits_(0), element_count_(0), records_size_(0), hasher_(hash), equal_(equal) {
+    attach(static_cast<const unsigned char*>(data), size);
+}
+
+//******************************************************************************
+//* @brief Move constructor. Takes over the other map's mapping.             *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+FrozenUnorderedMap<Key, T, Hash, KeyEqual>::FrozenUnorderedMap(FrozenUnorderedMap&& other) noexcept
+    : mapping_(other.mapping_), mapping_size_(other.mapping_size_), offsets_(other.offsets_),
+      records_(other.records_), bucket_bits_(other.bucket_bits_), element_count_(other.element_count_),
+      records_size_(other.records_size_), hasher_(std::move(other.hasher_)), equal_(std::move(other.equal_)) {
+    other.mapping_ = nullptr;
+    other.mapping_size_ = 0;
+}
+
+//******************************************************************************
+//* @brief Unmaps the snapshot file, if this map mapped one.                 *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+FrozenUnorderedMap<Key, T, Hash, KeyEqual>::~FrozenUnorderedMap() {
+    unmap();
+}
+
+//******************************************************************************
+//* @brief Move assignment. Releases this map's mapping and takes over the   *
+//* other's.                                                            *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+FrozenUnorderedMap<Key, T, Hash, KeyEqual>& FrozenUnorderedMap<Key, T, Hash, KeyEqual>::operator=(FrozenUnorderedMap&& other) noexcept {
+    if (this == &other) return *this;
+    unmap();
+    mapping_ = other.mapping_;
+    mapping_size_ = other.mapping_size_;
+    offsets_ = other.offsets_;
+    records_ = other.records_;
+    bucket_bits_ = other.bucket_bits_;
+    element_count_ = other.element_count_;
+    records_size_ = other.records_size_;
+    hasher_ = std::move(other.hasher_);
+    equal_ = std::move(other.equal_);
+    other.mapping_ = nullptr;
+    other.mapping_size_ = 0;
+    return *this;
+}
+
+//******************************************************************************
+//* @brief Looks up a key. Records in the key's bucket are compared by      *
+//* stored hash first, and the key equality predicate only runs on a    *
+//* hash match. The bucket's range is checked against the records here, *
+//* rather than the whole offset table when the map is opened.          *
+//* *
+//* @param key The key to search for.                                        *
+//* @return A view of the mapped value, or std::nullopt if key is absent.   *
+//* @throws std::runtime_error if the bucket's offsets are out of order or  *
+//* past the records, or a record in it runs past its end.     *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+std::optional<typename FrozenUnorderedMap<Key, T, Hash, KeyEqual>::mapped_view>
+FrozenUnorderedMap<Key, T, Hash, KeyEqual>::find(const Key& key) const {
+    if (element_count_ == 0) return std::nullopt;
+    uint64_t hash = hasher_(key);
+    uint64_t b = detail::snapshot_bucket(hash, bucket_bits_);
+    uint64_t begin = offset(b), limit = offset(b + 1);
+    if (begin > limit || limit > records_size_) throw std::runtime_error("snapshot offset table is corrupt");
+    const unsigned char* p = records_ + begin;
+    const unsigned char* end = records_ + limit;
+    while (p < end) {
+        detail::check_record_space(p, end, sizeof(uint64_t));
+        uint64_t stored = detail::load_raw<uint64_t>(p);
+        p += sizeof(uint64_t);
+        key_view k = serializer<Key>::view(p, end);
+        mapped_view v = serializer<T>::view(p, end);
+        if (stored == hash && keys_equal(key, k)) return v;
+    }
+    return std::nullopt;
+}
+
+//******************************************************************************
+//* @brief Returns true if the snapshot holds the key.                       *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+bool FrozenUnorderedMap<Key, T, Hash, KeyEqual>::contains(const Key& key) const {
+    return find(key).has_value();
+}
+
+//******************************************************************************
+//* @brief Calls f(key, value) on every record, in file order, with views   *
+//* of both. The records are walked end to end, so the offset table is *
+//* not consulted.                                                      *
+//* *
+//* @param f The function to call with each record.                         *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+template<class F>
+void FrozenUnorderedMap<Key, T, Hash, KeyEqual>::for_each(F&& f) const {
+    if (element_count_ == 0) return;
+    const unsigned char* p = records_;
+    const unsigned char* end = records_ + records_size_;
+    while (p < end) {
+        detail::check_record_space(p, end, sizeof(uint64_t));
+        p += sizeof(uint64_t);
+        key_view k = serializer<Key>::view(p, end);
+        mapped_view v = serializer<T>::view(p, end);
+        f(k, v);
+    }
+}
+
+//******************************************************************************
+//* @brief Returns true if the snapshot holds no elements.                   *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+bool FrozenUnorderedMap<Key, T, Hash, KeyEqual>::empty() const {
+    return element_count_ == 0;
+}
+
+//******************************************************************************
+//* @brief Returns the number of elements in the snapshot.                   *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+typename FrozenUnorderedMap<Key, T, Hash, KeyEqual>::size_type FrozenUnorderedMap<Key, T, Hash, KeyEqual>::size() const {
+    return static_cast<size_type>(element_count_);
+}
+
+//******************************************************************************
+//* @brief Returns the number of buckets in the snapshot's offset table.    *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+typename FrozenUnorderedMap<Key, T, Hash, KeyEqual>::size_type FrozenUnorderedMap<Key, T, Hash, KeyEqual>::bucket_count() const {
+    return size_type(1) << bucket_bits_;
+}
+
+//******************************************************************************
+//* @brief Checks the header and that the offset table and records fit in  *
+//* the given memory, then points the lookup state into it. Only the    *
+//* first and last offsets are checked here, which touches two pages;   *
+//* reading all 2^bucket_bits of them would page in the whole table.   *
+//* find() checks each bucket's range as it uses it, and the records   *
+//* are bounds-checked as they are decoded.                             *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+void FrozenUnorderedMap<Key, T, Hash, KeyEqual>::attach(const unsigned char* data, size_type size) {
+    if (size < sizeof(detail::SnapshotHeader)) throw std::runtime_error("snapshot truncated");
+    auto header = detail::load_raw<detail::SnapshotHeader>(data);
+    detail::check_snapshot_header(header, serializer<Key>::fixed_size, serializer<T>::fixed_size);
+    uint64_t offsets_size = ((uint64_t(1) << header.bucket_bits) + 1) * sizeof(uint64_t);
+    uint64_t body = size - sizeof(detail::SnapshotHeader);
+    if (body < offsets_size || body - offsets_size < header.records_size) {
+        throw std::runtime_error("snapshot truncated");
+    }
+    offsets_ = data + sizeof(detail::SnapshotHeader);
+    records_ = offsets_ + offsets_size;
+    bucket_bits_ = header.bucket_bits;
+    element_count_ = header.element_count;
+    records_size_ = header.records_size;
+    if (offset(0) != 0 || offset(bucket_count()) != records_size_) {
+        throw std::runtime_error("snapshot offset table is corrupt");
+    }
+}
+
+//******************************************************************************
+//* @brief Releases the file mapping, if any.                                *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+void FrozenUnorderedMap<Key, T, Hash, KeyEqual>::unmap() {
+#if __has_include(<sys/mman.h>)
+    if (mapping_) ::munmap(mapping_, mapping_size_);
+#endif
+    mapping_ = nullptr;
+    mapping_size_ = 0;
+}
+
+//******************************************************************************
+//* @brief Compares a key with one viewed in the snapshot. The predicate is *
+//* used when it accepts the view type; otherwise, as for string keys   *
+//* with std::equal_to<std::string>, the key is compared with ==, which *
+//* avoids building a temporary Key.                                    *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+bool FrozenUnorderedMap<Key, T, Hash, KeyEqual>::keys_equal(const Key& key, const key_view& stored) const {
+    if constexpr (std::is_invocable_r<bool, const KeyEqual&, const Key&, const key_view&>::value) {
+        return equal_(key, stored);
+    } else {
+        return key == stored;
+    }
+}
+
+//******************************************************************************
+//* @brief Reads entry b of the offset table.                                *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+uint64_t FrozenUnorderedMap<Key, T, Hash, KeyEqual>::offset(uint64_t bucket) const {
+    return detail::load_raw<uint64_t>(offsets_ + bucket * sizeof(uint64_t));
+}
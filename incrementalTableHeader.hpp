@@ -0,0 +1,133 @@
+#ifndef INCREMENTAL_TABLE_HPP
+#define INCREMENTAL_TABLE_HPP
+
+#include <cstddef>
+#include <utility>
+
+#include "chainedTableHeader.hpp"
+
+namespace detail {
+
+// Chained table that grows without stopping the world, in the style of the
+// Redis dict. A rehash allocates the new bucket array and keeps the old one
+// as a draining table; every later insertion relinks a few of its buckets
+// into the new array until it is empty. Lookups consult the draining table
+// for buckets it has not handed over yet. Hashes are always stored, so
+// moving a node never calls the hash function, which the table has no copy
+// of.
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+class IncrementalTable {
+    using inner_table = ChainedTable<Value, IndexPolicy, true, Allocator>;
+
+public:
+    using value_type = Value;
+    using size_type = size_t;
+    using allocator_type = Allocator;
+    using node_list = typename inner_table::node_list;
+
+    struct position {
+        typename inner_table::position inner;
+        bool draining;
+
+        bool operator==(const position& o) const { return inner == o.inner && draining == o.draining; }
+        bool operator!=(const position& o) const { return !(*this == o); }
+    };
+
+    struct const_position {
+        typename inner_table::const_position inner;
+        bool draining;
+
+        bool operator==(const const_position& o) const { return inner == o.inner && draining == o.draining; }
+        bool operator!=(const const_position& o) const { return !(*this == o); }
+    };
+
+    static constexpr float default_max_load_factor = inner_table::default_max_load_factor;
+    static size_type max_load(size_type bucket_count, float max_load_factor);
+
+    IncrementalTable(size_type bucket_count, const Allocator& alloc);
+    IncrementalTable(const IncrementalTable& other, const Allocator& alloc);
+    IncrementalTable(IncrementalTable&& other) noexcept = default;
+    IncrementalTable& operator=(IncrementalTable&& other) noexcept = default;
+
+    allocator_type get_allocator() const;
+    size_type bucket_count() const;
+    size_type bucket_size(size_type i) const;
+    size_type index_for(size_type hash) const;
+    size_type tombstones() const;
+    bool rehashing() const;
+
+    template<typename K, typename Eq>
+    position find(const K& key, size_type hash, const Eq& eq);
+    template<typename K, typename Eq>
+    const_position find(const K& key, size_type hash, const Eq& eq) const;
+    template<typename K, typename Eq>
+    const_position find(const K& key, size_type hash, const Eq& eq, size_type& probes) const;
+    void prefetch(size_type hash) const;
+    void prefetch_chain(size_type hash) const;
+    template<typename K, typename Eq>
+    size_type probe_length(const K& key, size_type hash, const Eq& eq) const;
+    MemoryUsage memory_usage() const;
+    template<typename... Args>
+    position emplace(size_type hash, Args&&... args);
+    void erase(const position& pos);
+    void extract(const position& pos, node_list& into);
+    position insert_node(size_type hash, node_list& from);
+    static const_position to_const(const position& pos);
+    position to_mutable(const const_position& pos);
+    void clear();
+    template<typename HashOf>
+    void rehash(size_type new_count, const HashOf& hash_of);
+    template<typename HashOf>
+    void reseed(const HashOf& hash_of);
+    void swap(IncrementalTable& other) noexcept;
+
+    position begin();
+    position end();
+    const_position begin() const;
+    const_position end() const;
+    size_type segments() const;
+    position seek(size_type segment);
+    const_position seek(size_type segment) const;
+    void next(position& pos);
+    void next(const_position& pos) const;
+    template<typename F>
+    void for_each(F& f);
+    template<typename F>
+    void for_each(F& f) const;
+    template<typename F, typename HashOf>
+    void for_each_hashed(F& f, const HashOf& hash_of) const;
+    value_type& value(const position& pos);
+    const value_type& value(const const_position& pos) const;
+
+private:
+    // Non-empty draining buckets relinked per insertion. Growth doubles the
+    // bucket count, so the draining table is always empty before the new
+    // one fills up.
+    static constexpr size_type MIGRATE_STEP = 4;
+
+    struct no_hash {
+        size_type operator()(const value_type&) const { return 0; }
+    };
+
+    bool unmigrated(size_type hash) const;
+    void migrate(size_type buckets);
+
+    inner_table active_;
+    // The previous bucket array while a resize is in progress, otherwise a
+    // table without buckets. Buckets below its first non-empty one have
+    // been handed over.
+    inner_table draining_;
+};
+
+} // namespace detail
+
+// Opt-in storage policy: separate chaining with incremental resizing, which
+// bounds the work any single insertion does to a few buckets.
+struct IncrementalStorage {
+    template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+    using table = detail::IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>;
+};
+
+#include "incrementalTableImplementation.tpp"
+
+#endif
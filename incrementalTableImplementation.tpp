@@ -0,0 +1,487 @@
+#include "incrementalTableHeader.hpp"
+
+namespace detail {
+
+//******************************************************************************
+//* @brief Returns the largest number of elements the table may hold with the *
+//* given bucket count before it has to grow.                          *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::size_type
+IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::max_load(size_type bucket_count, float max_load_factor) {
+    return inner_table::max_load(bucket_count, max_load_factor);
+}
+
+//******************************************************************************
+//* @brief Constructs a table of empty buckets with no resize in progress.   *
+//* *
+//* @param bucket_count The number of buckets to allocate.                   *
+//* @param alloc        The allocator to draw memory from.                   *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::IncrementalTable(size_type bucket_count, const Allocator& alloc)
+    : active_(bucket_count, alloc), draining_(0, alloc) {}
+
+//******************************************************************************
+//* @brief Clone constructor. Copies both bucket arrays as they are, so a    *
+//* resize in progress carries on in the copy.                         *
+//* *
+//* @param other The table to copy.                                          *
+//* @param alloc The allocator for the bucket arrays and the new nodes.      *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::IncrementalTable(const IncrementalTable& other, const Allocator& alloc)
+    : active_(other.active_, alloc), draining_(other.draining_, alloc) {}
+
+//******************************************************************************
+//* @brief Returns a copy of the allocator the table was constructed with.   *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::allocator_type
+IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::get_allocator() const {
+    return active_.get_allocator();
+}
+
+//******************************************************************************
+//* @brief Returns the number of buckets of the new array. Elements that    *
+//* still wait in the draining array are not counted per bucket.        *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::size_type IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::bucket_count() const {
+    return active_.bucket_count();
+}
+
+//******************************************************************************
+//* @brief Returns the number of elements chained in bucket i of the new     *
+//* array.                                                             *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::size_type IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::bucket_size(size_type i) const {
+    return active_.bucket_size(i);
+}
+
+//******************************************************************************
+//* @brief Maps a hash value to its bucket in the new array.                 *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::size_type IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::index_for(size_type hash) const {
+    return active_.index_for(hash);
+}
+
+//******************************************************************************
+//* @brief Returns the number of erased-but-unreclaimed slots, always zero.  *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::size_type IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::tombstones() const {
+    return 0;
+}
+
+//******************************************************************************
+//* @brief Returns true while a resize is in progress.                       *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+bool IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::rehashing() const {
+    return draining_.bucket_count() != 0;
+}
+
+//******************************************************************************
+//* @brief Looks up a key, first in its draining bucket if that bucket has    *
+//* not been handed over yet, then in the new array.                    *
+//* *
+//* @param key  The key to search for.                                        *
+//* @param hash The hash of the key.                                          *
+//* @param eq   The key equality predicate.                                   *
+//* @return The position of the matching element, or end().                  *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename K, typename Eq>
+typename IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::position
+IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::find(const K& key, size_type hash, const Eq& eq) {
+    if (unmigrated(hash)) {
+        auto pos = draining_.find(key, hash, eq);
+        if (pos != draining_.end()) return { pos, true };
+    }
+    return { active_.find(key, hash, eq), false };
+}
+
+//******************************************************************************
+//* @brief Looks up a key in both bucket arrays (const version).             *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename K, typename Eq>
+typename IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::const_position
+IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::find(const K& key, size_type hash, const Eq& eq) const {
+    if (unmigrated(hash)) {
+        auto pos = draining_.find(key, hash, eq);
+        if (pos != draining_.end()) return { pos, true };
+    }
+    return { active_.find(key, hash, eq), false };
+}
+
+//******************************************************************************
+//* @brief Looks up a key like find() and also counts the nodes visited in *
+//* both bucket arrays.                                                 *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename K, typename Eq>
+typename IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::const_position
+IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::find(const K& key, size_type hash, const Eq& eq, size_type& probes) const {
+    probes = 0;
+    if (unmigrated(hash)) {
+        auto pos = draining_.find(key, hash, eq, probes);
+        if (pos != draining_.end()) return { pos, true };
+    }
+    size_type active_probes;
+    auto pos = active_.find(key, hash, eq, active_probes);
+    probes += active_probes;
+    return { pos, false };
+}
+
+//******************************************************************************
+//* @brief Starts loading the bucket a hash selects, in the draining array   *
+//* too if that bucket has not been handed over.                        *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::prefetch(size_type hash) const {
+    if (unmigrated(hash)) draining_.prefetch(hash);
+    active_.prefetch(hash);
+}
+
+//******************************************************************************
+//* @brief Starts loading the first node of the bucket(s) a hash selects.    *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::prefetch_chain(size_type hash) const {
+    if (unmigrated(hash)) draining_.prefetch_chain(hash);
+    active_.prefetch_chain(hash);
+}
+
+//******************************************************************************
+//* @brief Counts the nodes a lookup for key visits in both bucket arrays.  *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename K, typename Eq>
+typename IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::size_type
+IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::probe_length(const K& key, size_type hash, const Eq& eq) const {
+    size_type probes;
+    find(key, hash, eq, probes);
+    return probes;
+}
+
+//******************************************************************************
+//* @brief Reports the memory held by both bucket arrays and their nodes.    *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+MemoryUsage IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::memory_usage() const {
+    MemoryUsage usage = active_.memory_usage();
+    MemoryUsage draining = draining_.memory_usage();
+    usage.table += draining.table;
+    usage.nodes += draining.nodes;
+    usage.allocations += draining.allocations;
+    return usage;
+}
+
+//******************************************************************************
+//* @brief Hands over a few draining buckets, then appends a new element to  *
+//* the new array. The caller guarantees that the key is not present.   *
+//* *
+//* @param hash The hash of the new element's key.                           *
+//* @param args Arguments forwarded to the value_type constructor.           *
+//* @return The position of the new element.                                *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename... Args>
+typename IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::position
+IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::emplace(size_type hash, Args&&... args) {
+    migrate(MIGRATE_STEP);
+    return { active_.emplace(hash, std::forward<Args>(args)...), false };
+}
+
+//******************************************************************************
+//* @brief Removes the element at the given position, in whichever array it *
+//* lives. Erasing never moves other elements.                          *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::erase(const position& pos) {
+    if (pos.draining) {
+        draining_.erase(pos.inner);
+    } else {
+        active_.erase(pos.inner);
+    }
+}
+
+
+//******************************************************************************
+//* @brief Relinks the node at a position onto the end of another list,    *
+//* from whichever array it lives in.                                   *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::extract(const position& pos, node_list& into) {
+    if (pos.draining) {
+        draining_.extract(pos.inner, into);
+    } else {
+        active_.extract(pos.inner, into);
+    }
+}
+
+//******************************************************************************
+//* @brief Relinks the first node of a list into the new array, relinking  *
+//* a few draining buckets first as emplace() does.                     *
+//* *
+//* @param hash The hash of the node's key.                                  *
+//* @param from The list to take the node from; must not be empty.          *
+//* @return The position of the inserted element.                           *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::position IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::insert_node(size_type hash, node_list& from) {
+    migrate(MIGRATE_STEP);
+    return { active_.insert_node(hash, from), false };
+}
+
+//******************************************************************************
+//* @brief Converts a position to its read-only form.                        *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::const_position
+IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::to_const(const position& pos) {
+    return { inner_table::to_const(pos.inner), pos.draining };
+}
+
+//******************************************************************************
+//* @brief Converts a read-only position back to a mutable one.              *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::position
+IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::to_mutable(const const_position& pos) {
+    if (pos.draining) return { draining_.to_mutable(pos.inner), true };
+    return { active_.to_mutable(pos.inner), false };
+}
+
+//******************************************************************************
+//* @brief Removes every element and drops the draining array, if any.      *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::clear() {
+    active_.clear();
+    draining_ = inner_table(0, get_allocator());
+}
+
+//******************************************************************************
+//* @brief Starts a resize: the current bucket array becomes the draining    *
+//* one and a new array of new_count buckets takes its place. No element  *
+//* moves yet. A resize still in progress is finished first. Shrinking  *
+//* is finished at once too, so that the larger array is released; the *
+//* map only shrinks sparse tables, which leaves few nodes to relink.  *
+//* *
+//* @param new_count The new number of buckets.                              *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename HashOf>
+void IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::rehash(size_type new_count, const HashOf&) {
+    migrate(draining_.bucket_count());
+    if (new_count == active_.bucket_count()) return;
+    inner_table fresh(new_count, get_allocator());
+    active_.swap(fresh);
+    draining_.swap(fresh);
+    migrate(new_count < draining_.bucket_count() ? draining_.bucket_count() : 0);
+}
+
+//******************************************************************************
+//* @brief Recomputes every hash after the hash function changed. A resize *
+//* in progress is finished first, so that one bucket array holds every *
+//* element; that array is then rebuilt at once.                        *
+//* *
+//* @param hash_of Returns the new hash of an element; must not throw.     *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename HashOf>
+void IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::reseed(const HashOf& hash_of) {
+    migrate(draining_.bucket_count());
+    active_.reseed(hash_of);
+}
+
+//******************************************************************************
+//* @brief Exchanges the bucket arrays of two tables.                        *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::swap(IncrementalTable& other) noexcept {
+    active_.swap(other.active_);
+    draining_.swap(other.draining_);
+}
+
+//******************************************************************************
+//* @brief Returns the position of the first element. Draining elements are *
+//* visited before those in the new array.                              *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::position IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::begin() {
+    auto pos = draining_.begin();
+    if (pos != draining_.end()) return { pos, true };
+    return { active_.begin(), false };
+}
+
+//******************************************************************************
+//* @brief Returns the past-the-end position.                                *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::position IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::end() {
+    return { active_.end(), false };
+}
+
+//******************************************************************************
+//* @brief Returns the position of the first element (const version).        *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::const_position IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::begin() const {
+    auto pos = draining_.begin();
+    if (pos != draining_.end()) return { pos, true };
+    return { active_.begin(), false };
+}
+
+//******************************************************************************
+//* @brief Returns the past-the-end position (const version).                *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::const_position IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::end() const {
+    return { active_.end(), false };
+}
+
+//******************************************************************************
+//* @brief Returns the number of segments iteration can be split at: the   *
+//* draining buckets, which are visited first, then the active ones.    *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::size_type IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::segments() const {
+    return draining_.segments() + active_.segments();
+}
+
+//******************************************************************************
+//* @brief Returns the first element at segment or later, or end().        *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::position IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::seek(size_type segment) {
+    size_type draining = draining_.segments();
+    if (segment >= draining) return { active_.seek(segment - draining), false };
+    auto pos = draining_.seek(segment);
+    if (pos != draining_.end()) return { pos, true };
+    return { active_.begin(), false };
+}
+
+//******************************************************************************
+//* @brief Returns the first element at segment or later (const version).  *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::const_position IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::seek(size_type segment) const {
+    size_type draining = draining_.segments();
+    if (segment >= draining) return { active_.seek(segment - draining), false };
+    auto pos = draining_.seek(segment);
+    if (pos != draining_.end()) return { pos, true };
+    return { active_.begin(), false };
+}
+
+//******************************************************************************
+//* @brief Moves a position to the next element, crossing from the draining *
+//* array into the new one after its last element.                      *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::next(position& pos) {
+    if (!pos.draining) {
+        active_.next(pos.inner);
+        return;
+    }
+    draining_.next(pos.inner);
+    if (pos.inner == draining_.end()) pos = { active_.begin(), false };
+}
+
+//******************************************************************************
+//* @brief Moves a position to the next element (const version).             *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::next(const_position& pos) const {
+    if (!pos.draining) {
+        active_.next(pos.inner);
+        return;
+    }
+    draining_.next(pos.inner);
+    if (pos.inner == draining_.end()) pos = { active_.begin(), false };
+}
+
+//******************************************************************************
+//* @brief Calls f on every element of both bucket arrays.                   *
+//* *
+//* @param f The function to call with each element.                        *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename F>
+void IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::for_each(F& f) {
+    draining_.for_each(f);
+    active_.for_each(f);
+}
+
+//******************************************************************************
+//* @brief Calls f on every element (const version).                         *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename F>
+void IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::for_each(F& f) const {
+    draining_.for_each(f);
+    active_.for_each(f);
+}
+
+//******************************************************************************
+//* @brief Calls f(element, hash) on every element with its stored hash.  *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<typename F, typename HashOf>
+void IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::for_each_hashed(F& f, const HashOf& hash_of) const {
+    draining_.for_each_hashed(f, hash_of);
+    active_.for_each_hashed(f, hash_of);
+}
+
+//******************************************************************************
+//* @brief Returns the element stored at a position.                         *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::value_type& IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::value(const position& pos) {
+    return pos.draining ? draining_.value(pos.inner) : active_.value(pos.inner);
+}
+
+//******************************************************************************
+//* @brief Returns the element stored at a position (const version).         *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+const typename IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::value_type& IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::value(const const_position& pos) const {
+    return pos.draining ? draining_.value(pos.inner) : active_.value(pos.inner);
+}
+
+//******************************************************************************
+//* @brief Checks whether an element with the given hash may still be in the *
+//* draining array, i.e. whether its bucket there is not handed over.  *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+bool IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::unmigrated(size_type hash) const {
+    return rehashing() && draining_.index_for(hash) >= draining_.begin().bucket;
+}
+
+//******************************************************************************
+//* @brief Relinks up to the given number of non-empty draining buckets into *
+//* the new array, lowest first, and drops the draining array once it is *
+//* empty. Empty buckets are skipped through the occupancy bitmap and  *
+//* do not count towards the limit.                                     *
+//* *
+//* @param buckets The maximum number of buckets to hand over.               *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+void IncrementalTable<Value, IndexPolicy, StoreHash, Allocator>::migrate(size_type buckets) {
+    while (rehashing()) {
+        size_type i = draining_.begin().bucket;
+        if (i >= draining_.bucket_count()) {
+            draining_ = inner_table(0, get_allocator());
+            return;
+        }
+        if (buckets-- == 0) return;
+        draining_.transfer_bucket(i, active_, no_hash{});
+    }
+}
+
+} // namespace detail
@@ -0,0 +1,147 @@
+#ifndef INDEX_POLICIES_HPP
+#define INDEX_POLICIES_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+// Bucket-index policies turn a hash value into a bucket (or slot) index.
+// Each one provides:
+//   mix(hash)               - post-processing applied to the raw hash
+//   index(mixed, count)     - reduction of a mixed hash to [0, count)
+//   bucket_count_for(n)     - smallest bucket count >= n the policy accepts
+//   high_bits_index         - true when index() is driven by the top bits
+//                             of the hash, so secondary uses should take
+//                             their bits from the bottom
+// FlatStorage ignores mix() and always applies detail::mix_hash, since
+// linear probing cannot afford the clustered home slots of a raw hash.
+
+namespace detail {
+
+constexpr uint64_t mulhi64(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+#else
+    uint64_t a_lo = a & 0xFFFFFFFFu, a_hi = a >> 32;
+    uint64_t b_lo = b & 0xFFFFFFFFu, b_hi = b >> 32;
+    uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo;
+    uint64_t lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+    uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFFu) + lo_hi;
+    return hi_hi + (hi_lo >> 32) + (cross >> 32);
+#endif
+}
+
+// Folded 128-bit multiply by the golden ratio: every input bit affects
+// every output bit, which identity hashes such as std::hash<int> lack.
+inline size_t mix_hash(size_t hash) {
+#if SIZE_MAX > 0xFFFFFFFFu
+    constexpr uint64_t k = 0x9E3779B97F4A7C15ull;
+    uint64_t lo = static_cast<uint64_t>(hash) * k;
+    return static_cast<size_t>(lo ^ mulhi64(hash, k));
+#else
+    constexpr uint64_t k = 0x9E3779B9u;
+    uint64_t r = static_cast<uint64_t>(hash) * k;
+    return static_cast<size_t>(r ^ (r >> 32));
+#endif
+}
+
+// Picks one of 2^shard_bits shards for a hash, for maps that split their
+// keys over several UnorderedMaps. The shard's own table indexes and tags
+// with the raw hash and with both ends of mix_hash(hash), so the shard
+// comes from a second multiply-mix with an unrelated constant. Taking
+// bits the table also uses would leave each shard's keys agreeing on
+// them: a shard of 16 would see 8 of FlatStorage's 128 tags, and
+// FastRangeIndex would crowd it into one sixteenth of its slots.
+inline size_t shard_index(size_t hash, size_t shard_bits) {
+    if (shard_bits == 0) return 0;
+#if SIZE_MAX > 0xFFFFFFFFu
+    constexpr uint64_t k = 0xD6E8FEB86659FD93ull;
+    uint64_t lo = static_cast<uint64_t>(hash) * k;
+    uint64_t r = lo ^ mulhi64(hash, k);
+#else
+    constexpr uint64_t k = 0x85EBCA6Bu;
+    uint64_t p = static_cast<uint64_t>(hash) * k;
+    uint32_t r = static_cast<uint32_t>(p ^ (p >> 32));
+#endif
+    return static_cast<size_t>(r >> (sizeof(r) * 8 - shard_bits));
+}
+
+} // namespace detail
+
+// hash % count on any bucket count. Matches the historical behaviour and
+// is the default.
+struct ModuloIndex {
+    static constexpr bool high_bits_index = false;
+
+    static size_t mix(size_t hash) { return hash; }
+    static size_t index(size_t hash, size_t count) { return hash % count; }
+    static size_t bucket_count_for(size_t n) { return n; }
+};
+
+// hash % count with bucket counts restricted to primes, which spreads
+// hashes that share low-bit patterns.
+struct PrimeIndex {
+    static constexpr bool high_bits_index = false;
+
+    static size_t mix(size_t hash) { return hash; }
+    static size_t index(size_t hash, size_t count) { return hash % count; }
+    static size_t bucket_count_for(size_t n) {
+        static constexpr uint64_t primes[] = {
+            2ull, 3ull, 5ull, 11ull, 17ull,
+            37ull, 67ull, 131ull, 257ull,
+            521ull, 1031ull, 2053ull, 4099ull,
+            8209ull, 16411ull, 32771ull, 65537ull,
+            131101ull, 262147ull, 524309ull, 1048583ull,
+            2097169ull, 4194319ull, 8388617ull, 16777259ull,
+            33554467ull, 67108879ull, 134217757ull, 268435459ull,
+            536870923ull, 1073741827ull, 2147483659ull, 4294967311ull,
+            8589934609ull, 17179869209ull, 34359738421ull, 68719476767ull,
+            137438953481ull, 274877906951ull, 549755813911ull, 1099511627791ull,
+            2199023255579ull, 4398046511119ull, 8796093022237ull, 17592186044423ull,
+            35184372088891ull, 70368744177679ull, 140737488355333ull, 281474976710677ull,
+            562949953421381ull, 1125899906842679ull, 2251799813685269ull, 4503599627370517ull,
+            9007199254740997ull, 18014398509482143ull, 36028797018963971ull, 72057594037928017ull,
+            144115188075855881ull, 288230376151711813ull, 576460752303423619ull, 1152921504606847009ull,
+            2305843009213693967ull, 4611686018427388039ull, 9223372036854775837ull,
+        };
+        if (n == 0) return 0;
+        const uint64_t* p = std::lower_bound(std::begin(primes), std::end(primes), static_cast<uint64_t>(n));
+        if (p == std::end(primes) || *p > SIZE_MAX) return n;
+        return static_cast<size_t>(*p);
+    }
+};
+
+// hash & (count - 1) on power-of-two bucket counts. The hash is mixed
+// first so that weak hashes still reach every bucket.
+struct PowerOfTwoIndex {
+    static constexpr bool high_bits_index = false;
+
+    static size_t mix(size_t hash) { return detail::mix_hash(hash); }
+    static size_t index(size_t hash, size_t count) { return hash & (count - 1); }
+    static size_t bucket_count_for(size_t n) {
+        if (n <= 1) return n;
+        size_t count = 1;
+        while (count < n) count <<= 1;
+        return count;
+    }
+};
+
+// Lemire's fast range reduction, (hash * count) >> bits, on any bucket
+// count. It keeps the top bits of the hash, so it needs a hash function
+// whose high bits are well distributed; the raw hash is not mixed.
+struct FastRangeIndex {
+    static constexpr bool high_bits_index = true;
+
+    static size_t mix(size_t hash) { return hash; }
+    static size_t index(size_t hash, size_t count) {
+#if SIZE_MAX > 0xFFFFFFFFu
+        return static_cast<size_t>(detail::mulhi64(hash, count));
+#else
+        return static_cast<size_t>((static_cast<uint64_t>(hash) * count) >> 32);
+#endif
+    }
+    static size_t bucket_count_for(size_t n) { return n; }
+};
+
+#endif
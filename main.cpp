@@ -1,7 +1,7 @@
 #include "unorderedMapHeader.hpp"
 
 int main() {
-    using Map = UnorderedMap<std::string, int>;
+    using Map = UnorderedMap<std::string, int, string_hash, string_equal>;
 
     std::cout << "--- Creating maps ---" << std::endl;
     Map m1;  // default constructor
@@ -75,5 +75,12 @@ int main() {
     m4.clear();
     std::cout << "m4.empty() after clear(): " << m4.empty() << "\n";
 
+    std::cout << "\n--- Flat Storage ---" << std::endl;
+    UnorderedMap<std::string, int, std::hash<std::string>, std::equal_to<std::string>, FlatStorage> flat{{"x", 1}, {"y", 2}};
+    flat["z"] = 3;
+    flat.erase("x");
+    std::cout << "flat contents: "; for (auto& kv: flat) std::cout << kv.first << "=" << kv.second << " "; std::cout << "\n";
+    std::cout << "flat.bucket_count(): " << flat.bucket_count() << ", max_load_factor: " << flat.max_load_factor() << "\n";
+
     return 0;
 }
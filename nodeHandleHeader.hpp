@@ -0,0 +1,63 @@
+#ifndef NODE_HANDLE_HPP
+#define NODE_HANDLE_HPP
+
+#include <memory>
+#include <optional>
+#include <utility>
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+class UnorderedMap;
+
+namespace detail {
+
+// Owns one element taken out of an UnorderedMap by extract(), in the style
+// of std::unordered_map::node_type. The element sits in a single chain
+// node, so a chained map hands it over and takes it back by relinking the
+// node, without allocating or copying. A handle may only be inserted into
+// a map whose allocator compares equal to its own.
+template<typename Key, typename T, typename Allocator, typename NodeList>
+class NodeHandle {
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<const Key, T>;
+    using allocator_type = Allocator;
+
+    NodeHandle() = default;
+    NodeHandle(const NodeHandle&) = delete;
+    NodeHandle(NodeHandle&&) = default;
+    NodeHandle& operator=(const NodeHandle&) = delete;
+    NodeHandle& operator=(NodeHandle&&) = default;
+
+    bool empty() const;
+    explicit operator bool() const;
+    allocator_type get_allocator() const;
+    const key_type& key() const;
+    mapped_type& mapped() const;
+    value_type& value() const;
+    void swap(NodeHandle& other) noexcept;
+
+private:
+    template<typename, typename, typename, typename, typename, typename, bool, typename, typename>
+    friend class ::UnorderedMap;
+
+    explicit NodeHandle(NodeList&& nodes);
+
+    // Holds exactly one node, or nothing when the handle is empty.
+    mutable std::optional<NodeList> nodes_;
+};
+
+// Result of inserting a node handle: where the key now is, whether the
+// node was inserted and, if it was not, the node itself.
+template<typename Iterator, typename NodeType>
+struct InsertReturn {
+    Iterator position;
+    bool inserted;
+    NodeType node;
+};
+
+} // namespace detail
+
+#include "nodeHandleImplementation.tpp"
+
+#endif
@@ -0,0 +1,69 @@
+#include "nodeHandleHeader.hpp"
+
+namespace detail {
+
+//******************************************************************************
+//* @brief Takes ownership of a list holding the extracted node.            *
+//******************************************************************************
+template<typename Key, typename T, typename Allocator, typename NodeList>
+NodeHandle<Key, T, Allocator, NodeList>::NodeHandle(NodeList&& nodes) : nodes_(std::move(nodes)) {}
+
+//******************************************************************************
+//* @brief Returns true when the handle holds no element.                   *
+//******************************************************************************
+template<typename Key, typename T, typename Allocator, typename NodeList>
+bool NodeHandle<Key, T, Allocator, NodeList>::empty() const {
+    return !nodes_ || nodes_->empty();
+}
+
+//******************************************************************************
+//* @brief Returns true when the handle holds an element.                   *
+//******************************************************************************
+template<typename Key, typename T, typename Allocator, typename NodeList>
+NodeHandle<Key, T, Allocator, NodeList>::operator bool() const {
+    return !empty();
+}
+
+//******************************************************************************
+//* @brief Returns the allocator the node was allocated with. The handle    *
+//* must not be empty.                                                 *
+//******************************************************************************
+template<typename Key, typename T, typename Allocator, typename NodeList>
+typename NodeHandle<Key, T, Allocator, NodeList>::allocator_type NodeHandle<Key, T, Allocator, NodeList>::get_allocator() const {
+    return allocator_type(nodes_->get_allocator());
+}
+
+//******************************************************************************
+//* @brief Returns the key of the element. The handle must not be empty.   *
+//******************************************************************************
+template<typename Key, typename T, typename Allocator, typename NodeList>
+const typename NodeHandle<Key, T, Allocator, NodeList>::key_type& NodeHandle<Key, T, Allocator, NodeList>::key() const {
+    return nodes_->front().value.first;
+}
+
+//******************************************************************************
+//* @brief Returns the mapped value of the element. The handle must not be *
+//* empty.                                                              *
+//******************************************************************************
+template<typename Key, typename T, typename Allocator, typename NodeList>
+typename NodeHandle<Key, T, Allocator, NodeList>::mapped_type& NodeHandle<Key, T, Allocator, NodeList>::mapped() const {
+    return nodes_->front().value.second;
+}
+
+//******************************************************************************
+//* @brief Returns the whole element. The handle must not be empty.         *
+//******************************************************************************
+template<typename Key, typename T, typename Allocator, typename NodeList>
+typename NodeHandle<Key, T, Allocator, NodeList>::value_type& NodeHandle<Key, T, Allocator, NodeList>::value() const {
+    return nodes_->front().value;
+}
+
+//******************************************************************************
+//* @brief Exchanges the elements of two handles.                           *
+//******************************************************************************
+template<typename Key, typename T, typename Allocator, typename NodeList>
+void NodeHandle<Key, T, Allocator, NodeList>::swap(NodeHandle& other) noexcept {
+    nodes_.swap(other.nodes_);
+}
+
+} // namespace detail
@@ -0,0 +1,89 @@
+#ifndef POOL_ALLOCATOR_HPP
+#define POOL_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+// Fixed-size-class memory pool for node-sized allocations. Requests of up
+// to MAX_POOLED bytes are rounded up to a multiple of GRANULE and served
+// from a per-class free list; the free lists are refilled by bumping
+// through BLOCK_SIZE chunks obtained from ::operator new. Larger requests
+// go straight to ::operator new. Memory handed back to the pool is reused
+// but only returned to the system by release() or destruction.
+class PoolResource {
+public:
+    static constexpr size_t GRANULE = 16;
+    static constexpr size_t MAX_POOLED = 256;
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    PoolResource() = default;
+    PoolResource(const PoolResource&) = delete;
+    PoolResource& operator=(const PoolResource&) = delete;
+    ~PoolResource();
+
+    void* allocate(size_t bytes, size_t alignment);
+    void deallocate(void* p, size_t bytes, size_t alignment);
+    void release();
+
+private:
+    struct FreeNode {
+        FreeNode* next;
+    };
+
+    static constexpr size_t NUM_CLASSES = MAX_POOLED / GRANULE;
+
+    static bool pooled(size_t bytes, size_t alignment);
+    static size_t class_of(size_t bytes);
+    void refill(size_t cls);
+
+    FreeNode* free_lists_[NUM_CLASSES] = {};
+    std::vector<void*> blocks_;
+    char* cursor_ = nullptr;
+    char* limit_ = nullptr;
+};
+
+// Standard allocator drawing from a shared PoolResource. Copies and
+// rebound copies share the pool and compare equal; a default-constructed
+// allocator owns a fresh pool. The pool follows the container on move
+// assignment and swap, while a copied container starts a pool of its own.
+template<typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    PoolAllocator();
+    explicit PoolAllocator(std::shared_ptr<PoolResource> pool);
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U>& other) noexcept;
+
+    T* allocate(size_t n);
+    void deallocate(T* p, size_t n) noexcept;
+    PoolAllocator select_on_container_copy_construction() const;
+
+    const std::shared_ptr<PoolResource>& resource() const noexcept { return pool_; }
+
+private:
+    template<typename U> friend class PoolAllocator;
+
+    std::shared_ptr<PoolResource> pool_;
+};
+
+template<typename T, typename U>
+bool operator==(const PoolAllocator<T>& a, const PoolAllocator<U>& b) noexcept {
+    return a.resource() == b.resource();
+}
+
+template<typename T, typename U>
+bool operator!=(const PoolAllocator<T>& a, const PoolAllocator<U>& b) noexcept {
+    return !(a == b);
+}
+
+#include "poolAllocatorImplementation.tpp"
+
+#endif
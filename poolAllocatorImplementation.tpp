@@ -0,0 +1,150 @@
+#include "poolAllocatorHeader.hpp"
+
+//******************************************************************************
+//* @brief Destroys the pool and returns every block to the system.          *
+//******************************************************************************
+inline PoolResource::~PoolResource() {
+    release();
+}
+
+//******************************************************************************
+//* @brief Checks whether a request is served from the size-class free lists.*
+//* Blocks come from ::operator new, so any alignment up to the        *
+//* fundamental one is honoured by the 16-byte granule.                *
+//******************************************************************************
+inline bool PoolResource::pooled(size_t bytes, size_t alignment) {
+    return bytes != 0 && bytes <= MAX_POOLED && alignment <= GRANULE &&
+           alignof(std::max_align_t) >= GRANULE;
+}
+
+//******************************************************************************
+//* @brief Returns the size class of a pooled request.                       *
+//******************************************************************************
+inline size_t PoolResource::class_of(size_t bytes) {
+    return (bytes + GRANULE - 1) / GRANULE - 1;
+}
+
+//******************************************************************************
+//* @brief Pushes at least one chunk of size class cls onto its free list,    *
+//* carving it from the current block or from a new one.              *
+//* *
+//* @param cls The size class to refill.                                      *
+//******************************************************************************
+inline void PoolResource::refill(size_t cls) {
+    const size_t chunk = (cls + 1) * GRANULE;
+    if (static_cast<size_t>(limit_ - cursor_) < chunk) {
+        blocks_.reserve(blocks_.size() + 1);
+        cursor_ = static_cast<char*>(::operator new(BLOCK_SIZE));
+        limit_ = cursor_ + BLOCK_SIZE;
+        blocks_.push_back(cursor_);
+    }
+    // Carve a handful of chunks at once so consecutive allocations of the
+    // same class end up next to each other.
+    for (int i = 0; i < 8 && static_cast<size_t>(limit_ - cursor_) >= chunk; ++i) {
+        FreeNode* node = reinterpret_cast<FreeNode*>(cursor_);
+        cursor_ += chunk;
+        node->next = free_lists_[cls];
+        free_lists_[cls] = node;
+    }
+}
+
+//******************************************************************************
+//* @brief Allocates memory for bytes bytes with the given alignment.        *
+//* *
+//* @param bytes     The number of bytes to allocate.                        *
+//* @param alignment The required alignment.                                 *
+//* @return A pointer to the allocated memory.                               *
+//* @throws std::bad_alloc If the system is out of memory.                  *
+//******************************************************************************
+inline void* PoolResource::allocate(size_t bytes, size_t alignment) {
+    if (!pooled(bytes, alignment)) {
+        return ::operator new(bytes);
+    }
+    const size_t cls = class_of(bytes);
+    if (!free_lists_[cls]) refill(cls);
+    FreeNode* node = free_lists_[cls];
+    free_lists_[cls] = node->next;
+    return node;
+}
+
+//******************************************************************************
+//* @brief Hands memory obtained from allocate() back to the pool.           *
+//* *
+//* @param p         The pointer returned by allocate().                     *
+//* @param bytes     The size passed to allocate().                          *
+//* @param alignment The alignment passed to allocate().                     *
+//******************************************************************************
+inline void PoolResource::deallocate(void* p, size_t bytes, size_t alignment) {
+    if (!p) return;
+    if (!pooled(bytes, alignment)) {
+        ::operator delete(p);
+        return;
+    }
+    FreeNode* node = static_cast<FreeNode*>(p);
+    const size_t cls = class_of(bytes);
+    node->next = free_lists_[cls];
+    free_lists_[cls] = node;
+}
+
+//******************************************************************************
+//* @brief Returns every block to the system at once. Any memory still      *
+//* handed out by the pool becomes invalid.                             *
+//******************************************************************************
+inline void PoolResource::release() {
+    for (void* block : blocks_) ::operator delete(block);
+    blocks_.clear();
+    for (auto& head : free_lists_) head = nullptr;
+    cursor_ = limit_ = nullptr;
+}
+
+//******************************************************************************
+//* @brief Constructs an allocator that owns a new, empty pool.              *
+//******************************************************************************
+template<typename T>
+PoolAllocator<T>::PoolAllocator() : pool_(std::make_shared<PoolResource>()) {}
+
+//******************************************************************************
+//* @brief Constructs an allocator drawing from an existing pool, so that    *
+//* several containers can share it.                                   *
+//* *
+//* @param pool The pool to allocate from.                                    *
+//******************************************************************************
+template<typename T>
+PoolAllocator<T>::PoolAllocator(std::shared_ptr<PoolResource> pool) : pool_(std::move(pool)) {}
+
+//******************************************************************************
+//* @brief Rebinding constructor. The new allocator shares other's pool.     *
+//******************************************************************************
+template<typename T>
+template<typename U>
+PoolAllocator<T>::PoolAllocator(const PoolAllocator<U>& other) noexcept : pool_(other.pool_) {}
+
+//******************************************************************************
+//* @brief Allocates storage for n objects of type T.                        *
+//* *
+//* @param n The number of objects.                                           *
+//* @return A pointer to uninitialised storage.                               *
+//* @throws std::bad_alloc If the size overflows or memory is exhausted.     *
+//******************************************************************************
+template<typename T>
+T* PoolAllocator<T>::allocate(size_t n) {
+    if (n > static_cast<size_t>(-1) / sizeof(T)) throw std::bad_alloc();
+    return static_cast<T*>(pool_->allocate(n * sizeof(T), alignof(T)));
+}
+
+//******************************************************************************
+//* @brief Returns storage for n objects of type T to the pool.              *
+//******************************************************************************
+template<typename T>
+void PoolAllocator<T>::deallocate(T* p, size_t n) noexcept {
+    pool_->deallocate(p, n * sizeof(T), alignof(T));
+}
+
+//******************************************************************************
+//* @brief Gives a copied container a pool of its own, so that the copy and *
+//* the original never contend for the same free lists.                *
+//******************************************************************************
+template<typename T>
+PoolAllocator<T> PoolAllocator<T>::select_on_container_copy_construction() const {
+    return PoolAllocator();
+}
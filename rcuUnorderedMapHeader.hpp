@@ -0,0 +1,168 @@
+#ifndef RCU_UNORDERED_MAP_HPP
+#define RCU_UNORDERED_MAP_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "unorderedMapHeader.hpp"
+
+namespace detail {
+
+// Epoch-based reclamation shared by every RcuUnorderedMap. A reader
+// announces the global epoch in a slot of its own before touching shared
+// data and clears it afterwards; those are plain stores, never atomic
+// read-modify-writes. A writer that unlinks an object advances the epoch
+// and may free the object once every announced epoch is newer than the
+// one it retired the object in. A thread that finds every slot taken
+// tries again once another thread has handed its slot back.
+class EpochDomain {
+public:
+    static constexpr size_t MAX_READERS = 256;
+    static constexpr size_t NO_SLOT = MAX_READERS;
+
+    static EpochDomain& instance();
+
+    void enter();
+    void leave();
+    bool active() const;
+    uint64_t advance();
+    uint64_t oldest_active() const;
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{0};
+        std::atomic<bool> owned{false};
+    };
+
+    // Per-thread reader state: the claimed slot and how deeply read-side
+    // sections are nested. The slot is handed back when the thread exits.
+    // After a failed claim, releases_seen holds the release count the
+    // claim saw, so the next claim waits until a slot has been freed.
+    struct ThreadReader {
+        size_t slot = NO_SLOT;
+        unsigned depth = 0;
+        bool failed = false;
+        uint64_t releases_seen = 0;
+        ~ThreadReader();
+    };
+
+    EpochDomain() = default;
+    ThreadReader& reader();
+    size_t claim_slot();
+
+    std::atomic<uint64_t> global_{1};
+    std::atomic<uint64_t> releases_{0};
+    Slot slots_[MAX_READERS];
+};
+
+// RAII read-side section. When every slot is taken the guard is inactive
+// and the caller must fall back to locking.
+class EpochGuard {
+public:
+    EpochGuard() : domain_(EpochDomain::instance()) { domain_.enter(); }
+    ~EpochGuard() { domain_.leave(); }
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+
+    explicit operator bool() const { return domain_.active(); }
+
+private:
+    EpochDomain& domain_;
+};
+
+} // namespace detail
+
+// Concurrent map for read-mostly workloads. Each shard publishes an
+// immutable UnorderedMap through an atomic pointer. Readers never lock and
+// never perform an atomic read-modify-write: they enter an epoch, load the
+// pointer and search the map it points to. Writers serialise per shard,
+// modify a copy of the shard's map (a layout clone, see the copy
+// constructor), publish it and retire the old one. Retired maps from all
+// shards share one list, so any write frees those no reader can still see,
+// and the destructor frees the rest. A write therefore costs a copy of one
+// shard, which suits tables that change rarely; use more shards to make it
+// cheaper.
+template<
+    typename Key,
+    typename T,
+    typename Hash = std::hash<Key>,
+    typename KeyEqual = std::equal_to<Key>,
+    typename Storage = ChainedStorage,
+    typename IndexPolicy = ModuloIndex,
+    bool StoreHash = !is_trivially_hashable<Key>::value,
+    typename Allocator = std::allocator<std::pair<const Key, T>>
+>
+class RcuUnorderedMap {
+public:
+    using map_type = UnorderedMap<Key, T, Hash, KeyEqual, Storage, IndexPolicy, StoreHash, Allocator>;
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<const Key, T>;
+    using size_type = size_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using allocator_type = Allocator;
+
+    explicit RcuUnorderedMap(size_type shard_count = DEFAULT_SHARD_COUNT,
+                             const Hash& hash = Hash(),
+                             const KeyEqual& equal = KeyEqual(),
+                             const Allocator& alloc = Allocator());
+    RcuUnorderedMap(const RcuUnorderedMap&) = delete;
+    RcuUnorderedMap& operator=(const RcuUnorderedMap&) = delete;
+    ~RcuUnorderedMap();
+
+    bool insert(const value_type& kv);
+    template<class... Args>
+    bool try_emplace(const Key& key, Args&&... args);
+    template<class M>
+    bool insert_or_assign(const Key& key, M&& obj);
+    template<class F>
+    bool update(const Key& key, F&& f);
+    size_type erase(const Key& key);
+    void clear();
+
+    std::optional<T> find(const Key& key) const;
+    bool contains(const Key& key) const;
+    template<class F>
+    bool visit(const Key& key, F&& f) const;
+    size_type size() const;
+    bool empty() const;
+    size_type shard_count() const;
+
+private:
+    static constexpr size_type DEFAULT_SHARD_COUNT = 16;
+    static constexpr size_type CACHE_LINE = 64;
+
+    struct Retired {
+        const map_type* map;
+        uint64_t epoch;
+    };
+
+    struct alignas(CACHE_LINE) Shard {
+        std::atomic<const map_type*> current{nullptr};
+        std::mutex write_mutex;
+    };
+
+    Shard& shard_for(size_type hash) const;
+    template<class F>
+    auto read(size_type hash, F&& f) const;
+    void publish(Shard& shard, std::unique_ptr<map_type> fresh);
+    void reclaim();
+
+    size_type shard_bits_;
+    std::unique_ptr<Shard[]> shards_;
+    Hash hasher_;
+    // Taken after a shard's write lock, never before it.
+    std::mutex retired_mutex_;
+    std::vector<Retired> retired_;
+};
+
+#include "rcuUnorderedMapImplementation.tpp"
+
+#endif
@@ -0,0 +1,426 @@
+#include "rcuUnorderedMapHeader.hpp"
+
+namespace detail {
+
+//******************************************************************************
+//* @brief Returns the process-wide epoch domain.                            *
+//******************************************************************************
+inline EpochDomain& EpochDomain::instance() {
+    static EpochDomain domain;
+    return domain;
+}
+
+//******************************************************************************
+//* @brief Returns the reader state of the calling thread.                   *
+//******************************************************************************
+inline EpochDomain::ThreadReader& EpochDomain::reader() {
+    static thread_local ThreadReader state;
+    return state;
+}
+
+//******************************************************************************
+//* @brief Hands a thread's slot back to the domain when the thread exits, *
+//* and counts the release so that threads left without a slot retry.  *
+//******************************************************************************
+inline EpochDomain::ThreadReader::~ThreadReader() {
+    if (slot == NO_SLOT) return;
+    EpochDomain& domain = EpochDomain::instance();
+    Slot& s = domain.slots_[slot];
+    s.epoch.store(0, std::memory_order_release);
+    s.owned.store(false, std::memory_order_release);
+    domain.releases_.fetch_add(1, std::memory_order_acq_rel);
+}
+
+//******************************************************************************
+//* @brief Claims a free reader slot for the calling thread. This is the only*
+//* read-side compare-and-swap. It runs on a thread's first read, and   *
+//* again after a failed claim only once some slot has been released.   *
+//* *
+//* @return The slot index, or NO_SLOT if all slots are owned.               *
+//******************************************************************************
+inline size_t EpochDomain::claim_slot() {
+    for (size_t i = 0; i < MAX_READERS; ++i) {
+        bool expected = false;
+        if (!slots_[i].owned.load(std::memory_order_relaxed) &&
+            slots_[i].owned.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+            return i;
+        }
+    }
+    return NO_SLOT;
+}
+
+//******************************************************************************
+//* @brief Enters a read-side section by announcing the current epoch. Nested*
+//* sections keep the epoch of the outermost one. A thread without a   *
+//* slot claims one first, unless its last claim failed and no slot has  *
+//* been released since; that check is a single load.                   *
+//******************************************************************************
+inline void EpochDomain::enter() {
+    ThreadReader& r = reader();
+    if (r.depth++ != 0) return;
+    if (r.slot == NO_SLOT) {
+        // Read the count before scanning, so that a release racing with a
+        // failed scan still triggers the next attempt.
+        uint64_t releases = releases_.load(std::memory_order_acquire);
+        if (!r.failed || releases != r.releases_seen) {
+            r.slot = claim_slot();
+            r.failed = r.slot == NO_SLOT;
+            r.releases_seen = releases;
+        }
+    }
+    if (r.slot == NO_SLOT) return;
+    // Both operations are sequentially consistent so that the announcement
+    // is ordered before every load the reader makes inside the section.
+    slots_[r.slot].epoch.store(global_.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+}
+
+//******************************************************************************
+//* @brief Leaves a read-side section.                                       *
+//******************************************************************************
+inline void EpochDomain::leave() {
+    ThreadReader& r = reader();
+    if (--r.depth != 0 || r.slot == NO_SLOT) return;
+    slots_[r.slot].epoch.store(0, std::memory_order_release);
+}
+
+//******************************************************************************
+//* @brief Returns true if the calling thread owns a slot, i.e. if its read- *
+//* side sections actually protect what they read.                      *
+//******************************************************************************
+inline bool EpochDomain::active() const {
+    return const_cast<EpochDomain*>(this)->reader().slot != NO_SLOT;
+}
+
+//******************************************************************************
+//* @brief Advances the global epoch. Called by a writer right after it has   *
+//* unlinked an object.                                                 *
+//* *
+//* @return The epoch the object was retired in.                             *
+//******************************************************************************
+inline uint64_t EpochDomain::advance() {
+    return global_.fetch_add(1, std::memory_order_seq_cst);
+}
+
+//******************************************************************************
+//* @brief Returns the oldest epoch announced by a reader still inside a     *
+//* section. An object retired in an earlier epoch is safe to free.     *
+//* *
+//* @return The oldest announced epoch, or UINT64_MAX if no reader is active.*
+//******************************************************************************
+inline uint64_t EpochDomain::oldest_active() const {
+    uint64_t oldest = UINT64_MAX;
+    for (const Slot& s : slots_) {
+        uint64_t announced = s.epoch.load(std::memory_order_seq_cst);
+        if (announced != 0 && announced < oldest) oldest = announced;
+    }
+    return oldest;
+}
+
+} // namespace detail
+
+//******************************************************************************
+//* @brief Constructs an empty map with at least shard_count shards, rounded *
+//* up to a power of two.                                              *
+//* *
+//* @param shard_count The minimum number of shards.                         *
+//* @param hash        The hash function object, shared by all shards.      *
+//* @param equal       The key equality predicate object.                  *
+//* @param alloc       The allocator each shard's map is built with.       *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+RcuUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::RcuUnorderedMap(size_type shard_count,
+                                                                                        const Hash& hash,
+                                                                                        const KeyEqual& equal,
+                                                                                        const Allocator& alloc)
+    : shard_bits_(0), hasher_(hash) {
+    while ((size_type(1) << shard_bits_) < shard_count && shard_bits_ + 1 < sizeof(size_type) * 8) ++shard_bits_;
+    shards_.reset(new Shard[size_type(1) << shard_bits_]);
+    for (size_type i = 0; i < this->shard_count(); ++i) {
+        shards_[i].current.store(new map_type(16, hash, equal, alloc), std::memory_order_relaxed);
+    }
+}
+
+//******************************************************************************
+//* @brief Destructor. Frees every published and retired map. No reader may *
+//* still be using the map.                                            *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+RcuUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::~RcuUnorderedMap() {
+    for (size_type i = 0; i < shard_count(); ++i) delete shards_[i].current.load(std::memory_order_relaxed);
+    for (const Retired& r : retired_) delete r.map;
+}
+
+//******************************************************************************
+//* @brief Returns the shard responsible for a key's hash. It is chosen the *
+//* same way as ConcurrentUnorderedMap's, by detail::shard_index.       *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename RcuUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::Shard&
+RcuUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::shard_for(size_type hash) const {
+    return shards_[detail::shard_index(hash, shard_bits_)];
+}
+
+//******************************************************************************
+//* @brief Runs f on the published map of the key's shard inside an epoch    *
+//* section. A thread that could not get a reader slot takes the shard's *
+//* write lock instead, which keeps writers from freeing the map.       *
+//* *
+//* @param hash The hash of the key whose shard to read.                     *
+//* @param f    The function to call with the shard's current map.           *
+//* @return Whatever f returns.                                              *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<class F>
+auto RcuUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::read(size_type hash, F&& f) const {
+    Shard& shard = shard_for(hash);
+    detail::EpochGuard guard;
+    if (guard) return f(*shard.current.load(std::memory_order_seq_cst));
+    std::lock_guard<std::mutex> lock(shard.write_mutex);
+    return f(*shard.current.load(std::memory_order_relaxed));
+}
+
+//******************************************************************************
+//* @brief Publishes a new map for a shard, retires the previous one and     *
+//* frees whatever no reader can still see, whichever shard retired it. *
+//* Must be called with the shard's write lock held.                    *
+//* *
+//* @param shard The shard to update.                                        *
+//* @param fresh The fully built replacement map.                            *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+void RcuUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::publish(Shard& shard, std::unique_ptr<map_type> fresh) {
+    const map_type* old = shard.current.load(std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(retired_mutex_);
+        retired_.reserve(retired_.size() + 1);
+        shard.current.store(fresh.release(), std::memory_order_seq_cst);
+        retired_.push_back({ old, detail::EpochDomain::instance().advance() });
+    }
+    reclaim();
+}
+
+//******************************************************************************
+//* @brief Frees the retired maps, from any shard, that no reader can still  *
+//* see.                                                                *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+void RcuUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::reclaim() {
+    std::lock_guard<std::mutex> lock(retired_mutex_);
+    uint64_t oldest = detail::EpochDomain::instance().oldest_active();
+    size_type kept = 0;
+    for (const Retired& r : retired_) {
+        if (r.epoch < oldest) {
+            delete r.map;
+        } else {
+            retired_[kept++] = r;
+        }
+    }
+    retired_.resize(kept);
+}
+
+//******************************************************************************
+//* @brief Inserts a copy of a key-value pair unless the key is present.    *
+//* *
+//* @param kv The key-value pair to insert.                                   *
+//* @return True if the pair was inserted, false if the key already existed.*
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+bool RcuUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::insert(const value_type& kv) {
+    size_type hash = hasher_(kv.first);
+    Shard& shard = shard_for(hash);
+    std::lock_guard<std::mutex> lock(shard.write_mutex);
+    const map_type* current = shard.current.load(std::memory_order_relaxed);
+    if (current->contains(kv.first, hash)) return false;
+    auto fresh = std::make_unique<map_type>(*current);
+    fresh->try_emplace_hashed(hash, kv.first, kv.second);
+    publish(shard, std::move(fresh));
+    return true;
+}
+
+//******************************************************************************
+//* @brief Constructs an element from key and args if the key is absent.    *
+//* An existing key costs a lookup and no copy of the shard.            *
+//* *
+//* @param key  The key of the element.                                       *
+//* @param args Arguments forwarded to the constructor of the mapped value.    *
+//* @return True if an element was inserted.                                 *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<class... Args>
+bool RcuUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::try_emplace(const Key& key, Args&&... args) {
+    size_type hash = hasher_(key);
+    Shard& shard = shard_for(hash);
+    std::lock_guard<std::mutex> lock(shard.write_mutex);
+    const map_type* current = shard.current.load(std::memory_order_relaxed);
+    if (current->contains(key, hash)) return false;
+    auto fresh = std::make_unique<map_type>(*current);
+    fresh->try_emplace_hashed(hash, key, std::forward<Args>(args)...);
+    publish(shard, std::move(fresh));
+    return true;
+}
+
+//******************************************************************************
+//* @brief Assigns obj to the element with the given key, or inserts it.    *
+//* *
+//* @param key The key of the element.                                        *
+//* @param obj The value to assign or insert.                                 *
+//* @return True if an insertion took place, false on assignment.           *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<class M>
+bool RcuUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::insert_or_assign(const Key& key, M&& obj) {
+    size_type hash = hasher_(key);
+    Shard& shard = shard_for(hash);
+    std::lock_guard<std::mutex> lock(shard.write_mutex);
+    auto fresh = std::make_unique<map_type>(*shard.current.load(std::memory_order_relaxed));
+    auto it = fresh->find(key, hash);
+    bool inserted = it == fresh->end();
+    if (inserted) {
+        fresh->try_emplace_hashed(hash, key, std::forward<M>(obj));
+    } else {
+        it->second = std::forward<M>(obj);
+    }
+    publish(shard, std::move(fresh));
+    return inserted;
+}
+
+//******************************************************************************
+//* @brief Modifies the element for key by calling f on it in a new copy of  *
+//* the shard, then publishes that copy. Readers see either the old or  *
+//* the new value, never a partial update.                             *
+//* *
+//* @param key The key of the element to update.                              *
+//* @param f   The function to call with a reference to the key-value pair.  *
+//* @return True if the key was found and updated.                          *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<class F>
+bool RcuUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::update(const Key& key, F&& f) {
+    size_type hash = hasher_(key);
+    Shard& shard = shard_for(hash);
+    std::lock_guard<std::mutex> lock(shard.write_mutex);
+    const map_type* current = shard.current.load(std::memory_order_relaxed);
+    if (!current->contains(key, hash)) return false;
+    auto fresh = std::make_unique<map_type>(*current);
+    f(*fresh->find(key, hash));
+    publish(shard, std::move(fresh));
+    return true;
+}
+
+//******************************************************************************
+//* @brief Erases the element with the specified key.                        *
+//* *
+//* @param key The key of the element to erase.                               *
+//* @return The number of elements erased (either 0 or 1).                     *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename RcuUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::size_type
+RcuUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::erase(const Key& key) {
+    size_type hash = hasher_(key);
+    Shard& shard = shard_for(hash);
+    std::lock_guard<std::mutex> lock(shard.write_mutex);
+    const map_type* current = shard.current.load(std::memory_order_relaxed);
+    if (!current->contains(key, hash)) return 0;
+    auto fresh = std::make_unique<map_type>(*current);
+    fresh->erase(key, hash);
+    publish(shard, std::move(fresh));
+    return 1;
+}
+
+//******************************************************************************
+//* @brief Replaces every shard with an empty map.                          *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+void RcuUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::clear() {
+    for (size_type i = 0; i < shard_count(); ++i) {
+        std::lock_guard<std::mutex> lock(shards_[i].write_mutex);
+        const map_type* current = shards_[i].current.load(std::memory_order_relaxed);
+        if (current->empty()) continue;
+        publish(shards_[i], std::make_unique<map_type>(16, current->hash_function(), current->key_eq(),
+                                                       current->get_allocator()));
+    }
+}
+
+//******************************************************************************
+//* @brief Looks up a key without taking any lock and returns a copy of its  *
+//* mapped value.                                                       *
+//* *
+//* @param key The key to search for.                                         *
+//* @return The mapped value, or an empty optional if the key is absent.     *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+std::optional<T> RcuUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::find(const Key& key) const {
+    size_type hash = hasher_(key);
+    return read(hash, [&](const map_type& map) -> std::optional<T> {
+        auto it = map.find(key, hash);
+        if (it == map.end()) return std::nullopt;
+        return it->second;
+    });
+}
+
+//******************************************************************************
+//* @brief Checks without taking any lock whether the map contains a key.   *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+bool RcuUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::contains(const Key& key) const {
+    size_type hash = hasher_(key);
+    return read(hash, [&](const map_type& map) { return map.contains(key, hash); });
+}
+
+//******************************************************************************
+//* @brief Calls f with a const reference to the element for key, without   *
+//* taking any lock. The element stays valid for the duration of f even *
+//* if a writer replaces it meanwhile.                                  *
+//* *
+//* @param key The key of the element to visit.                               *
+//* @param f   The function to call with the key-value pair.                 *
+//* @return True if the key was found and f was called.                     *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+template<class F>
+bool RcuUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::visit(const Key& key, F&& f) const {
+    size_type hash = hasher_(key);
+    return read(hash, [&](const map_type& map) {
+        auto it = map.find(key, hash);
+        if (it == map.end()) return false;
+        f(*it);
+        return true;
+    });
+}
+
+//******************************************************************************
+//* @brief Returns the number of elements. Shards are read one after another *
+//* without locking, so concurrent writes may be partly reflected.      *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename RcuUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::size_type
+RcuUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::size() const {
+    size_type total = 0;
+    detail::EpochGuard guard;
+    for (size_type i = 0; i < shard_count(); ++i) {
+        if (guard) {
+            total += shards_[i].current.load(std::memory_order_seq_cst)->size();
+        } else {
+            std::lock_guard<std::mutex> lock(shards_[i].write_mutex);
+            total += shards_[i].current.load(std::memory_order_relaxed)->size();
+        }
+    }
+    return total;
+}
+
+//******************************************************************************
+//* @brief Checks whether the map is empty.                                  *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+bool RcuUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::empty() const {
+    return size() == 0;
+}
+
+//******************************************************************************
+//* @brief Returns the number of shards.                                     *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator>
+typename RcuUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::size_type
+RcuUnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator>::shard_count() const {
+    return size_type(1) << shard_bits_;
+}
@@ -0,0 +1,92 @@
+#ifndef SEEDED_HASH_HPP
+#define SEEDED_HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "indexPoliciesHeader.hpp"
+
+namespace detail {
+
+// Default inner hash of SeededHash: std::hash of whatever key it is given.
+struct StdHash {
+    template<typename K>
+    size_t operator()(const K& key) const { return std::hash<K>{}(key); }
+};
+
+// Gives SeededHash an is_transparent member exactly when its inner hash
+// has one.
+template<typename Hash, typename = void>
+struct TransparentTag {};
+
+template<typename Hash>
+struct TransparentTag<Hash, std::void_t<typename Hash::is_transparent>> {
+    using is_transparent = typename Hash::is_transparent;
+};
+
+// True for hashers that can draw a new seed, which puts UnorderedMap into
+// hardened mode.
+template<typename Hash, typename = void>
+struct is_reseedable : std::false_type {};
+
+template<typename Hash>
+struct is_reseedable<Hash, std::void_t<decltype(std::declval<Hash&>().reseed())>> : std::true_type {};
+
+// Map size below which a hardened map does not reseed again. Reseeding
+// rehashes everything, so allowing it once per doubling keeps its cost
+// amortized constant even against keys no seed can separate. spent()
+// counts the reseeds, so code holding hashes can tell they went stale.
+template<bool Hardened>
+struct ReseedBudget {
+    bool allows(size_t) const { return false; }
+    void spend(size_t) {}
+    size_t spent() const { return 0; }
+};
+
+template<>
+struct ReseedBudget<true> {
+    bool allows(size_t size) const { return size >= floor; }
+    void spend(size_t size) { floor = 2 * size; ++reseeds; }
+    size_t spent() const { return reseeds; }
+
+    size_t floor = 0;
+    size_t reseeds = 0;
+};
+
+uint64_t fresh_seed();
+uint64_t hash_bytes(const void* data, size_t length, uint64_t seed);
+
+} // namespace detail
+
+// Hash adapter for maps whose keys come from untrusted input. Every
+// instance draws a random seed, so an attacker cannot predict which keys
+// share a bucket. String-like keys are hashed byte by byte with a keyed
+// multiply-mix hash, so no fixed set of strings collides under every seed;
+// other keys mix the inner hash with the seed, which separates them as
+// well as the inner hash does. An UnorderedMap using it reseeds and
+// rehashes itself when a probe grows suspiciously long.
+template<typename Hash = detail::StdHash>
+class SeededHash : public detail::TransparentTag<Hash> {
+public:
+    explicit SeededHash(const Hash& hash = Hash());
+    SeededHash(const Hash& hash, uint64_t seed);
+
+    template<typename K>
+    size_t operator()(const K& key) const;
+
+    uint64_t seed() const;
+    void reseed();
+    void reseed(uint64_t seed);
+
+private:
+    Hash hash_;
+    uint64_t seed_;
+};
+
+#include "seededHashImplementation.tpp"
+
+#endif
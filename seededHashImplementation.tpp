@@ -0,0 +1,139 @@
+#include "seededHashHeader.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <random>
+
+namespace detail {
+
+//******************************************************************************
+//* @brief Returns a new seed. The random device is read once per process;  *
+//* later seeds step a counter from that point and mix it, so that      *
+//* constructing a map costs no system call.                            *
+//******************************************************************************
+inline uint64_t fresh_seed() {
+    static const uint64_t base = (uint64_t(std::random_device{}()) << 32) ^ std::random_device{}();
+    static std::atomic<uint64_t> counter{0};
+    uint64_t n = base + counter.fetch_add(0x9E3779B97F4A7C15ull, std::memory_order_relaxed);
+    return n * 0xBF58476D1CE4E5B9ull ^ mulhi64(n, 0x94D049BB133111EBull);
+}
+
+//******************************************************************************
+//* @brief Multiplies two words to 128 bits and folds the halves together. *
+//******************************************************************************
+inline uint64_t fold_multiply(uint64_t a, uint64_t b) {
+    return a * b ^ mulhi64(a, b);
+}
+
+//******************************************************************************
+//* @brief Reads 8 bytes from unaligned memory.                              *
+//******************************************************************************
+inline uint64_t read64(const unsigned char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+//******************************************************************************
+//* @brief Reads 4 bytes from unaligned memory.                              *
+//******************************************************************************
+inline uint64_t read32(const unsigned char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+//******************************************************************************
+//* @brief Keyed hash of a byte string. Consumes 16 bytes per step, each  *
+//* step folding a 128-bit product of input words and the running       *
+//* state, which starts from the seed; the tail of 1 to 16 bytes is     *
+//* read as two possibly overlapping words. Both factors of every       *
+//* product depend on the seed. A factor that did not would be zeroed  *
+//* by one chosen input word, and the product with it, so every string *
+//* sharing what follows that word would hash alike under all seeds.    *
+//* *
+//* @param data   The bytes to hash.                                          *
+//* @param length The number of bytes.                                        *
+//* @param seed   The key; different seeds give unrelated hash functions.     *
+//* @return The 64-bit hash.                                                 *
+//******************************************************************************
+inline uint64_t hash_bytes(const void* data, size_t length, uint64_t seed) {
+    constexpr uint64_t k0 = 0xA0761D6478BD642Full;
+    constexpr uint64_t k1 = 0xE7037ED1A0B428DBull;
+    constexpr uint64_t k2 = 0x8EBC6AF09C88C6E3ull;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    size_t n = length;
+    const uint64_t s = seed ^ k1;
+    uint64_t h = seed ^ k0;
+    for (; n > 16; p += 16, n -= 16) h = fold_multiply(read64(p) ^ s, read64(p + 8) ^ h);
+    uint64_t a = 0, b = 0;
+    if (n >= 8) {
+        a = read64(p);
+        b = read64(p + n - 8);
+    } else if (n >= 4) {
+        a = read32(p);
+        b = read32(p + n - 4);
+    } else if (n > 0) {
+        a = (uint64_t(p[0]) << 16) | (uint64_t(p[n / 2]) << 8) | p[n - 1];
+    }
+    h = fold_multiply(a ^ s, b ^ h);
+    return fold_multiply(h ^ k2, uint64_t(length) ^ k1);
+}
+
+} // namespace detail
+
+//******************************************************************************
+//* @brief Constructs the adapter with a fresh random seed.                  *
+//* *
+//* @param hash The inner hash, used for keys that are not string-like.     *
+//******************************************************************************
+template<typename Hash>
+SeededHash<Hash>::SeededHash(const Hash& hash) : hash_(hash), seed_(detail::fresh_seed()) {}
+
+//******************************************************************************
+//* @brief Constructs the adapter with a given seed, e.g. for reproducible  *
+//* tests.                                                              *
+//******************************************************************************
+template<typename Hash>
+SeededHash<Hash>::SeededHash(const Hash& hash, uint64_t seed) : hash_(hash), seed_(seed) {}
+
+//******************************************************************************
+//* @brief Hashes a key under the current seed. Anything convertible to    *
+//* std::string_view is hashed by its bytes, so std::string, views and  *
+//* literals of equal text hash alike; other keys mix the inner hash.   *
+//******************************************************************************
+template<typename Hash>
+template<typename K>
+size_t SeededHash<Hash>::operator()(const K& key) const {
+    if constexpr (std::is_convertible<const K&, std::string_view>::value) {
+        std::string_view bytes(key);
+        return static_cast<size_t>(detail::hash_bytes(bytes.data(), bytes.size(), seed_));
+    } else {
+        return static_cast<size_t>(detail::fold_multiply(uint64_t(hash_(key)) ^ seed_, seed_ | 1));
+    }
+}
+
+//******************************************************************************
+//* @brief Returns the current seed.                                         *
+//******************************************************************************
+template<typename Hash>
+uint64_t SeededHash<Hash>::seed() const {
+    return seed_;
+}
+
+//******************************************************************************
+//* @brief Draws a new random seed. Every hash changes, so a map using this *
+//* hasher must rehash all its elements afterwards.                     *
+//******************************************************************************
+template<typename Hash>
+void SeededHash<Hash>::reseed() {
+    seed_ = detail::fresh_seed();
+}
+
+//******************************************************************************
+//* @brief Switches to a given seed.                                         *
+//******************************************************************************
+template<typename Hash>
+void SeededHash<Hash>::reseed(uint64_t seed) {
+    seed_ = seed;
+}
@@ -0,0 +1,154 @@
+#ifndef SMALL_TABLE_HPP
+#define SMALL_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "chainedTableHeader.hpp"
+#include "controlGroupHeader.hpp"
+#include "indexPoliciesHeader.hpp"
+#include "statsPolicyHeader.hpp"
+
+namespace detail {
+
+// Keeps up to N elements in an array inside the map object and finds them
+// by comparing full hashes across the whole array, then keys on a match;
+// the hash comparison has no branches and vectorizes. Past N elements the
+// table spills into an Inner table, which starts with no buckets, so a map
+// that stays small never allocates. Positions carry both a slot and an
+// Inner position: inline they are {slot, inner end}, spilled {N, inner}.
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+class SmallTable {
+    static_assert(N >= 1 && N <= 64, "SmallStorage keeps between 1 and 64 elements inline");
+
+public:
+    using value_type = Value;
+    using size_type = size_t;
+    using allocator_type = Allocator;
+    using inner_table = typename Inner::template table<Value, IndexPolicy, StoreHash, Allocator>;
+    using node_list = typename inner_table::node_list;
+
+    struct position {
+        size_type slot;
+        typename inner_table::position inner;
+
+        bool operator==(const position& o) const { return slot == o.slot && inner == o.inner; }
+        bool operator!=(const position& o) const { return !(*this == o); }
+    };
+
+    struct const_position {
+        size_type slot;
+        typename inner_table::const_position inner;
+
+        bool operator==(const const_position& o) const { return slot == o.slot && inner == o.inner; }
+        bool operator!=(const const_position& o) const { return !(*this == o); }
+    };
+
+    static constexpr float default_max_load_factor = inner_table::default_max_load_factor;
+    static size_type max_load(size_type bucket_count, float max_load_factor);
+
+    SmallTable(size_type bucket_count, const Allocator& alloc);
+    SmallTable(const SmallTable&) = delete;
+    SmallTable(const SmallTable& other, const Allocator& alloc);
+    SmallTable(SmallTable&& other) noexcept;
+    ~SmallTable();
+
+    SmallTable& operator=(const SmallTable&) = delete;
+    SmallTable& operator=(SmallTable&& other) noexcept;
+
+    allocator_type get_allocator() const;
+    size_type bucket_count() const;
+    size_type bucket_size(size_type i) const;
+    size_type index_for(size_type hash) const;
+    size_type tombstones() const;
+
+    template<typename K, typename Eq>
+    position find(const K& key, size_type hash, const Eq& eq);
+    template<typename K, typename Eq>
+    const_position find(const K& key, size_type hash, const Eq& eq) const;
+    template<typename K, typename Eq>
+    const_position find(const K& key, size_type hash, const Eq& eq, size_type& probes) const;
+    void prefetch(size_type hash) const;
+    void prefetch_chain(size_type hash) const;
+    template<typename K, typename Eq>
+    size_type probe_length(const K& key, size_type hash, const Eq& eq) const;
+    MemoryUsage memory_usage() const;
+    template<typename... Args>
+    position emplace(size_type hash, Args&&... args);
+    void erase(const position& pos);
+    void extract(const position& pos, node_list& into);
+    position insert_node(size_type hash, node_list& from);
+    static const_position to_const(const position& pos);
+    position to_mutable(const const_position& pos);
+    void clear();
+    template<typename HashOf>
+    void rehash(size_type new_count, const HashOf& hash_of);
+    template<typename HashOf>
+    void reseed(const HashOf& hash_of);
+    void swap(SmallTable& other) noexcept;
+
+    position begin();
+    position end();
+    const_position begin() const;
+    const_position end() const;
+    size_type segments() const;
+    position seek(size_type segment);
+    const_position seek(size_type segment) const;
+    void next(position& pos);
+    void next(const_position& pos) const;
+    template<typename F>
+    void for_each(F& f);
+    template<typename F>
+    void for_each(F& f) const;
+    template<typename F, typename HashOf>
+    void for_each_hashed(F& f, const HashOf& hash_of) const;
+    value_type& value(const position& pos);
+    const value_type& value(const const_position& pos) const;
+
+private:
+    using slot_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<value_type>;
+    using alloc_traits = std::allocator_traits<slot_allocator>;
+    using mask_type = uint64_t;
+
+    static constexpr mask_type FULL_MASK = N == 64 ? ~mask_type(0) : (mask_type(1) << N) - 1;
+
+    static size_type spill_count();
+    value_type* slot(size_type i);
+    const value_type* slot(size_type i) const;
+    mask_type match(size_type hash) const;
+    size_type next_used(size_type from) const;
+    void take_inline(SmallTable& other) noexcept;
+    void destroy_inline() noexcept;
+    void spill(size_type new_count);
+    template<typename HashOf>
+    void unspill(const HashOf& hash_of);
+
+    slot_allocator alloc_;
+    alignas(value_type) unsigned char storage_[N * sizeof(value_type)];
+    // Full hash of each inline slot; stale in unused slots, which match()
+    // masks out.
+    size_type hashes_[N];
+    // Bit i is set while inline slot i holds an element.
+    mask_type used_;
+    bool spilled_;
+    inner_table inner_;
+};
+
+} // namespace detail
+
+// Storage policy for maps that usually hold only a few elements: the first
+// N live inside the map object and nothing is allocated until the map
+// outgrows them, after which elements move to Inner storage.
+template<size_t N = 8, typename Inner = ChainedStorage>
+struct SmallStorage {
+    template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator>
+    using table = detail::SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>;
+};
+
+#include "smallTableImplementation.tpp"
+
+#endif
@@ -0,0 +1,670 @@
+#include "smallTableHeader.hpp"
+
+namespace detail {
+
+//******************************************************************************
+//* @brief Returns the largest number of elements allowed for the given     *
+//* bucket count. Inline storage reports N buckets and holds N elements *
+//* whatever the load factor; a spilled table never has N or fewer     *
+//* buckets, so larger counts are the inner table's.                   *
+//* *
+//* @param bucket_count    The number of buckets.                             *
+//* @param max_load_factor The maximum average number of elements per bucket.*
+//* @return The element limit for that bucket count.                         *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::size_type
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::max_load(size_type bucket_count, float max_load_factor) {
+    return bucket_count <= N ? N : inner_table::max_load(bucket_count, max_load_factor);
+}
+
+//******************************************************************************
+//* @brief Constructs an empty table. Elements start out inline and the     *
+//* inner table has no buckets, so nothing is allocated; the requested *
+//* bucket count is ignored until the table spills.                     *
+//* *
+//* @param bucket_count Ignored; reserve() sizes the spilled table.           *
+//* @param alloc        The allocator for the inner table and for            *
+//* constructing inline elements.                           *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::SmallTable(size_type, const Allocator& alloc)
+    : alloc_(alloc), hashes_{}, used_(0), spilled_(false), inner_(0, alloc) {}
+
+//******************************************************************************
+//* @brief Clone constructor. Copies the inline elements slot for slot with *
+//* their hashes, and clones the inner table, so nothing is rehashed.   *
+//* *
+//* @param other The table to copy.                                          *
+//* @param alloc The allocator for the new table.                            *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::SmallTable(const SmallTable& other, const Allocator& alloc)
+    : alloc_(alloc), hashes_{}, used_(0), spilled_(other.spilled_), inner_(other.inner_, alloc) {
+    try {
+        for (mask_type m = other.used_; m; m &= m - 1) {
+            size_type i = countr_zero64(m);
+            alloc_traits::construct(alloc_, slot(i), *other.slot(i));
+            hashes_[i] = other.hashes_[i];
+            used_ |= mask_type(1) << i;
+        }
+    } catch (...) {
+        destroy_inline();
+        throw;
+    }
+}
+
+//******************************************************************************
+//* @brief Move constructor. Takes over the inner table and moves the inline *
+//* elements, leaving other empty and inline. Moving a pair with a const *
+//* key copies the key, so unlike the other storages this move touches *
+//* every inline element, and a key copy that throws terminates.        *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::SmallTable(SmallTable&& other) noexcept
+    : alloc_(other.alloc_), hashes_{}, used_(0), spilled_(other.spilled_), inner_(std::move(other.inner_)) {
+    other.spilled_ = false;
+    take_inline(other);
+}
+
+//******************************************************************************
+//* @brief Destructor. Destroys the inline elements; the inner table cleans *
+//* up after itself.                                                    *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::~SmallTable() {
+    destroy_inline();
+}
+
+//******************************************************************************
+//* @brief Move assignment operator. Releases this table's elements and     *
+//* takes over other's, as the move constructor does.                  *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>&
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::operator=(SmallTable&& other) noexcept {
+    if (this != &other) {
+        destroy_inline();
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+            alloc_ = other.alloc_;
+        }
+        inner_ = std::move(other.inner_);
+        spilled_ = other.spilled_;
+        other.spilled_ = false;
+        take_inline(other);
+    }
+    return *this;
+}
+
+//******************************************************************************
+//* @brief Returns a copy of the allocator the table was constructed with.   *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::allocator_type
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::get_allocator() const {
+    return allocator_type(alloc_);
+}
+
+//******************************************************************************
+//* @brief Returns N while the elements are inline, and the inner table's   *
+//* bucket count once spilled.                                           *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::size_type
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::bucket_count() const {
+    return spilled_ ? inner_.bucket_count() : N;
+}
+
+//******************************************************************************
+//* @brief Returns the number of elements in bucket i. Inline elements all  *
+//* count as bucket 0, the only bucket index_for() reports.              *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::size_type
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::bucket_size(size_type i) const {
+    if (spilled_) return inner_.bucket_size(i);
+    if (i != 0) return 0;
+    size_type count = 0;
+    for (mask_type m = used_; m; m &= m - 1) ++count;
+    return count;
+}
+
+//******************************************************************************
+//* @brief Maps a hash value to a bucket: always 0 while inline, since any  *
+//* inline element may sit in any slot.                                 *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::size_type
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::index_for(size_type hash) const {
+    return spilled_ ? inner_.index_for(hash) : 0;
+}
+
+//******************************************************************************
+//* @brief Returns the inner table's tombstones. Inline erasure just clears *
+//* a bit and leaves none.                                              *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::size_type
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::tombstones() const {
+    return spilled_ ? inner_.tombstones() : 0;
+}
+
+//******************************************************************************
+//* @brief Looks up a key. Inline, every stored hash is compared at once and *
+//* only slots whose hash matches have their key compared.              *
+//* *
+//* @param key  The key to search for.                                       *
+//* @param hash The hash of key.                                             *
+//* @param eq   The key equality predicate, called as eq(stored_key, key).    *
+//* @return The element's position, or end() if key is absent.             *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+template<typename K, typename Eq>
+typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::position
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::find(const K& key, size_type hash, const Eq& eq) {
+    if (spilled_) return { N, inner_.find(key, hash, eq) };
+    for (mask_type m = match(hash); m; m &= m - 1) {
+        size_type i = countr_zero64(m);
+        if (eq(slot(i)->first, key)) return { i, inner_.end() };
+    }
+    return end();
+}
+
+//******************************************************************************
+//* @brief Looks up a key (const version).                                  *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+template<typename K, typename Eq>
+typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::const_position
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::find(const K& key, size_type hash, const Eq& eq) const {
+    if (spilled_) return { N, inner_.find(key, hash, eq) };
+    for (mask_type m = match(hash); m; m &= m - 1) {
+        size_type i = countr_zero64(m);
+        if (eq(slot(i)->first, key)) return { i, inner_.end() };
+    }
+    return end();
+}
+
+//******************************************************************************
+//* @brief Looks up a key like find() and also counts the probes, as       *
+//* probe_length() reports them.                                        *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+template<typename K, typename Eq>
+typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::const_position
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::find(const K& key, size_type hash, const Eq& eq, size_type& probes) const {
+    if (spilled_) return { N, inner_.find(key, hash, eq, probes) };
+    probes = 1;
+    return find(key, hash, eq);
+}
+
+//******************************************************************************
+//* @brief Starts loading the inner bucket a hash selects into the cache. *
+//* Inline elements live in the map object and need no prefetch.        *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+void SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::prefetch(size_type hash) const {
+    if (spilled_) inner_.prefetch(hash);
+}
+
+//******************************************************************************
+//* @brief Starts loading the first element of the inner bucket a hash     *
+//* selects into the cache.                                             *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+void SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::prefetch_chain(size_type hash) const {
+    if (spilled_) inner_.prefetch_chain(hash);
+}
+
+//******************************************************************************
+//* @brief Returns the number of probes a lookup of key takes. An inline    *
+//* lookup is a single scan of the hash array and counts as one.       *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+template<typename K, typename Eq>
+typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::size_type
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::probe_length(const K& key, size_type hash, const Eq& eq) const {
+    size_type probes;
+    find(key, hash, eq, probes);
+    return probes;
+}
+
+//******************************************************************************
+//* @brief Reports the memory held by the inner table. The inline slots are *
+//* part of the map object, which the map counts itself.               *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+MemoryUsage SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::memory_usage() const {
+    return inner_.memory_usage();
+}
+
+//******************************************************************************
+//* @brief Constructs a new element in the lowest free inline slot, or in   *
+//* the inner table once spilled. A full inline table spills first; the *
+//* map normally spills it through rehash() before that happens.        *
+//* *
+//* @param hash The hash of the new element's key.                           *
+//* @param args Arguments forwarded to the element's constructor.            *
+//* @return The position of the new element.                                 *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+template<typename... Args>
+typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::position
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::emplace(size_type hash, Args&&... args) {
+    if (!spilled_ && used_ == FULL_MASK) spill(spill_count());
+    if (spilled_) return { N, inner_.emplace(hash, std::forward<Args>(args)...) };
+    size_type i = countr_zero64(~used_);
+    alloc_traits::construct(alloc_, slot(i), std::forward<Args>(args)...);
+    hashes_[i] = hash;
+    used_ |= mask_type(1) << i;
+    return { i, inner_.end() };
+}
+
+//******************************************************************************
+//* @brief Removes the element at a position. Inline elements are not      *
+//* compacted, so positions of the others stay valid.                   *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+void SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::erase(const position& pos) {
+    if (spilled_) {
+        inner_.erase(pos.inner);
+        return;
+    }
+    alloc_traits::destroy(alloc_, slot(pos.slot));
+    used_ &= ~(mask_type(1) << pos.slot);
+}
+
+
+//******************************************************************************
+//* @brief Hands the element at a position over to the end of a list:     *
+//* spilled elements as the inner table does, inline ones by moving     *
+//* them into a new node.                                               *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+void SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::extract(const position& pos, node_list& into) {
+    if (spilled_) {
+        inner_.extract(pos.inner, into);
+        return;
+    }
+    into.emplace_back(hashes_[pos.slot], std::move(*slot(pos.slot)));
+    erase(pos);
+}
+
+//******************************************************************************
+//* @brief Inserts the element of the first node of a list: through the    *
+//* inner table once spilled, otherwise by moving it into a free inline *
+//* slot, spilling first if there is none.                              *
+//* *
+//* @param hash The hash of the node's key.                                  *
+//* @param from The list to take the node from; must not be empty.          *
+//* @return The position of the inserted element.                           *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::position SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::insert_node(size_type hash, node_list& from) {
+    if (!spilled_ && used_ == FULL_MASK) spill(spill_count());
+    if (spilled_) return { N, inner_.insert_node(hash, from) };
+    position pos = emplace(hash, std::move(from.front().value));
+    from.pop_front();
+    return pos;
+}
+
+//******************************************************************************
+//* @brief Converts a position to a const_position.                         *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::const_position
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::to_const(const position& pos) {
+    return { pos.slot, inner_table::to_const(pos.inner) };
+}
+
+//******************************************************************************
+//* @brief Converts a const_position back to a position in this table.      *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::position
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::to_mutable(const const_position& pos) {
+    return { pos.slot, inner_.to_mutable(pos.inner) };
+}
+
+//******************************************************************************
+//* @brief Removes every element. A spilled table keeps its inner buckets. *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+void SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::clear() {
+    if (spilled_) {
+        inner_.clear();
+    } else {
+        destroy_inline();
+    }
+}
+
+//******************************************************************************
+//* @brief Resizes the table. Inline, a count above N spills the elements  *
+//* into an inner table of that size and smaller counts change nothing. *
+//* Spilled, a count of N or less brings the elements back inline and  *
+//* frees the inner table if they fit; otherwise the inner table is     *
+//* rehashed, to more than N buckets.                                   *
+//* *
+//* @param new_count The new number of buckets.                             *
+//* @param hash_of   Computes the hash of an element being moved back inline.*
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+template<typename HashOf>
+void SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::rehash(size_type new_count, const HashOf& hash_of) {
+    if (!spilled_) {
+        if (new_count > N) spill(new_count);
+        return;
+    }
+    if (new_count <= N) {
+        size_type count = 0;
+        auto counter = [&count](const value_type&) { ++count; };
+        static_cast<const inner_table&>(inner_).for_each(counter);
+        if (count <= N) {
+            unspill(hash_of);
+            return;
+        }
+        new_count = spill_count();
+    }
+    inner_.rehash(new_count, hash_of);
+}
+
+//******************************************************************************
+//* @brief Recomputes every hash after the hash function changed. Inline  *
+//* elements only need their entry in the hash array replaced.          *
+//* *
+//* @param hash_of Returns the new hash of an element; must not throw.     *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+template<typename HashOf>
+void SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::reseed(const HashOf& hash_of) {
+    if (spilled_) {
+        inner_.reseed(hash_of);
+        return;
+    }
+    for (size_type i = next_used(0); i < N; i = next_used(i + 1)) hashes_[i] = hash_of(*slot(i));
+}
+
+//******************************************************************************
+//* @brief Exchanges the contents of two tables. Inline elements are moved, *
+//* as by the move constructor.                                         *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+void SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::swap(SmallTable& other) noexcept {
+    if (this == &other) return;
+    SmallTable tmp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(tmp);
+}
+
+//******************************************************************************
+//* @brief Returns the position of the first element, or end() if the table *
+//* is empty.                                                           *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::position
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::begin() {
+    if (spilled_) return { N, inner_.begin() };
+    return { next_used(0), inner_.end() };
+}
+
+//******************************************************************************
+//* @brief Returns the past-the-end position.                               *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::position
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::end() {
+    return { N, inner_.end() };
+}
+
+//******************************************************************************
+//* @brief Returns the position of the first element (const version).       *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::const_position
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::begin() const {
+    if (spilled_) return { N, inner_.begin() };
+    return { next_used(0), inner_.end() };
+}
+
+//******************************************************************************
+//* @brief Returns the past-the-end position (const version).               *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::const_position
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::end() const {
+    return { N, inner_.end() };
+}
+
+//******************************************************************************
+//* @brief Returns the number of segments iteration can be split at: the   *
+//* inline slots, or the inner table's segments once spilled.          *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::size_type SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::segments() const {
+    return spilled_ ? inner_.segments() : N;
+}
+
+//******************************************************************************
+//* @brief Returns the first element at segment or later, or end().        *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::position SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::seek(size_type segment) {
+    if (spilled_) return { N, inner_.seek(segment) };
+    return { next_used(segment), inner_.end() };
+}
+
+//******************************************************************************
+//* @brief Returns the first element at segment or later (const version).  *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::const_position SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::seek(size_type segment) const {
+    if (spilled_) return { N, inner_.seek(segment) };
+    return { next_used(segment), inner_.end() };
+}
+
+//******************************************************************************
+//* @brief Moves a position to the next element, in slot order while inline.*
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+void SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::next(position& pos) {
+    if (spilled_) {
+        inner_.next(pos.inner);
+        return;
+    }
+    pos.slot = next_used(pos.slot + 1);
+}
+
+//******************************************************************************
+//* @brief Moves a position to the next element (const version).            *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+void SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::next(const_position& pos) const {
+    if (spilled_) {
+        inner_.next(pos.inner);
+        return;
+    }
+    pos.slot = next_used(pos.slot + 1);
+}
+
+//******************************************************************************
+//* @brief Calls f on every element.                                        *
+//* *
+//* @param f The function to call with each element.                        *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+template<typename F>
+void SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::for_each(F& f) {
+    if (spilled_) {
+        inner_.for_each(f);
+        return;
+    }
+    for (mask_type m = used_; m; m &= m - 1) f(*slot(countr_zero64(m)));
+}
+
+//******************************************************************************
+//* @brief Calls f on every element (const version).                        *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+template<typename F>
+void SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::for_each(F& f) const {
+    if (spilled_) {
+        inner_.for_each(f);
+        return;
+    }
+    for (mask_type m = used_; m; m &= m - 1) f(*slot(countr_zero64(m)));
+}
+
+//******************************************************************************
+//* @brief Calls f(element, hash) on every element. Inline slots always   *
+//* keep their hash; spilled elements get theirs from the inner table.  *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+template<typename F, typename HashOf>
+void SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::for_each_hashed(F& f, const HashOf& hash_of) const {
+    if (spilled_) {
+        inner_.for_each_hashed(f, hash_of);
+        return;
+    }
+    for (mask_type m = used_; m; m &= m - 1) {
+        size_type i = countr_zero64(m);
+        f(*slot(i), hashes_[i]);
+    }
+}
+
+//******************************************************************************
+//* @brief Returns the element at a position.                               *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::value_type&
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::value(const position& pos) {
+    return pos.slot < N ? *slot(pos.slot) : inner_.value(pos.inner);
+}
+
+//******************************************************************************
+//* @brief Returns the element at a position (const version).               *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+const typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::value_type&
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::value(const const_position& pos) const {
+    return pos.slot < N ? *slot(pos.slot) : inner_.value(pos.inner);
+}
+
+//******************************************************************************
+//* @brief Returns the bucket count a table spills into when an insert     *
+//* finds the inline slots full: the policy's first count above 2N.     *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::size_type
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::spill_count() {
+    return IndexPolicy::bucket_count_for(2 * N);
+}
+
+//******************************************************************************
+//* @brief Returns inline slot i, which may or may not hold an element.    *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::value_type*
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::slot(size_type i) {
+    return std::launder(reinterpret_cast<value_type*>(storage_)) + i;
+}
+
+//******************************************************************************
+//* @brief Returns inline slot i (const version).                           *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+const typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::value_type*
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::slot(size_type i) const {
+    return std::launder(reinterpret_cast<const value_type*>(storage_)) + i;
+}
+
+//******************************************************************************
+//* @brief Returns a mask of the used inline slots whose stored hash equals *
+//* hash. The loop has no branches and compiles to vector compares.    *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::mask_type
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::match(size_type hash) const {
+    mask_type m = 0;
+    for (size_type i = 0; i < N; ++i) m |= mask_type(hashes_[i] == hash) << i;
+    return m & used_;
+}
+
+//******************************************************************************
+//* @brief Returns the first used inline slot at or after from, or N.       *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+typename SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::size_type
+SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::next_used(size_type from) const {
+    if (from >= N) return N;
+    mask_type rest = used_ & (~mask_type(0) << from);
+    return rest ? countr_zero64(rest) : N;
+}
+
+//******************************************************************************
+//* @brief Moves other's inline elements into the same slots of this table, *
+//* which must have none, and leaves other with none.                   *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+void SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::take_inline(SmallTable& other) noexcept {
+    for (mask_type m = other.used_; m; m &= m - 1) {
+        size_type i = countr_zero64(m);
+        alloc_traits::construct(alloc_, slot(i), std::move(*other.slot(i)));
+        alloc_traits::destroy(other.alloc_, other.slot(i));
+        hashes_[i] = other.hashes_[i];
+    }
+    used_ = other.used_;
+    other.used_ = 0;
+}
+
+//******************************************************************************
+//* @brief Destroys the inline elements.                                    *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+void SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::destroy_inline() noexcept {
+    for (mask_type m = used_; m; m &= m - 1) alloc_traits::destroy(alloc_, slot(countr_zero64(m)));
+    used_ = 0;
+}
+
+//******************************************************************************
+//* @brief Moves the inline elements into a new inner table with the given *
+//* bucket count, reusing their stored hashes.                          *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+void SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::spill(size_type new_count) {
+    inner_table fresh(new_count, get_allocator());
+    for (mask_type m = used_; m; m &= m - 1) {
+        size_type i = countr_zero64(m);
+        fresh.emplace(hashes_[i], std::move(*slot(i)));
+    }
+    destroy_inline();
+    inner_ = std::move(fresh);
+    spilled_ = true;
+}
+
+//******************************************************************************
+//* @brief Moves the inner table's elements, of which there are at most N,  *
+//* back into the inline slots and replaces the inner table with one   *
+//* that has no buckets, which frees its memory.                        *
+//******************************************************************************
+template<typename Value, typename IndexPolicy, bool StoreHash, typename Allocator, size_t N, typename Inner>
+template<typename HashOf>
+void SmallTable<Value, IndexPolicy, StoreHash, Allocator, N, Inner>::unspill(const HashOf& hash_of) {
+    inner_table fresh(0, get_allocator());
+    size_type i = 0;
+    auto move_in = [&](value_type& v) {
+        hashes_[i] = hash_of(v);
+        alloc_traits::construct(alloc_, slot(i), std::move(v));
+        used_ |= mask_type(1) << i;
+        ++i;
+    };
+    try {
+        inner_.for_each(move_in);
+    } catch (...) {
+        destroy_inline();
+        throw;
+    }
+    inner_ = std::move(fresh);
+    spilled_ = false;
+}
+
+} // namespace detail
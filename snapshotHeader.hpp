@@ -0,0 +1,101 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "indexPoliciesHeader.hpp"
+
+// How keys and mapped values are written to a snapshot. The primary
+// template copies the object representation and only accepts trivially
+// copyable types; specialize it for anything else. A serializer provides:
+//   fixed_size          - the encoded size, or 0 when it varies
+//   size(value)         - the encoded size of one value
+//   write(out, value)   - encodes a value
+//   read(in)            - decodes a value from a stream
+//   view(p, end)        - decodes a value in place from mapped memory,
+//                         advancing p past it, without allocating; throws
+//                         std::runtime_error rather than read past end
+template<typename T>
+struct serializer {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "snapshots copy trivially copyable types byte for byte; specialize serializer<T> for other types");
+
+    using view_type = T;
+    static constexpr uint64_t fixed_size = sizeof(T);
+
+    static size_t size(const T&) { return sizeof(T); }
+    static void write(std::ostream& out, const T& value);
+    static T read(std::istream& in);
+    static view_type view(const unsigned char*& p, const unsigned char* end);
+};
+
+// Strings are stored as a 64-bit length followed by the characters, and
+// viewed in place as a std::string_view.
+template<>
+struct serializer<std::string> {
+    using view_type = std::string_view;
+    static constexpr uint64_t fixed_size = 0;
+
+    static size_t size(const std::string& value);
+    static void write(std::ostream& out, const std::string& value);
+    static std::string read(std::istream& in);
+    static view_type view(const unsigned char*& p, const unsigned char* end);
+};
+
+namespace detail {
+
+// Snapshot layout, shared by UnorderedMap::save()/load() and
+// FrozenUnorderedMap:
+//   SnapshotHeader
+//   uint64_t offsets[2^bucket_bits + 1]   byte offset of each bucket's
+//                                         first record, then the end
+//   records, grouped by bucket            uint64_t hash, key, value
+// All integers are in the byte order of the machine that wrote the file;
+// the order_mark field rejects files from the other byte order.
+struct SnapshotHeader {
+    static constexpr char MAGIC[8] = { 'U', 'M', 'A', 'P', 'S', 'N', 'A', 'P' };
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t ORDER_MARK = 0x01020304;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t order_mark;
+    uint64_t key_size;
+    uint64_t value_size;
+    uint64_t bucket_bits;
+    uint64_t element_count;
+    uint64_t records_size;
+};
+
+static_assert(sizeof(SnapshotHeader) % 8 == 0, "snapshot offsets must stay 8-byte aligned");
+
+SnapshotHeader make_snapshot_header(uint64_t key_size, uint64_t value_size, uint64_t element_count);
+void check_snapshot_header(const SnapshotHeader& header, uint64_t key_size, uint64_t value_size);
+uint64_t snapshot_bucket(uint64_t hash, uint64_t bucket_bits);
+void check_record_space(const unsigned char* p, const unsigned char* end, uint64_t size);
+
+void write_bytes(std::ostream& out, const char* data, size_t size);
+void read_bytes(std::istream& in, char* data, size_t size);
+void skip_bytes(std::istream& in, uint64_t size);
+uint64_t bytes_left(std::istream& in);
+template<typename T>
+void write_raw(std::ostream& out, const T& value);
+template<typename T>
+T read_raw(std::istream& in);
+template<typename T>
+T load_raw(const unsigned char* p);
+
+} // namespace detail
+
+#include "snapshotImplementation.tpp"
+
+#endif
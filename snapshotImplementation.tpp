@@ -0,0 +1,250 @@
+#include "snapshotHeader.hpp"
+
+//******************************************************************************
+//* @brief Writes the object representation of a trivially copyable value.  *
+//******************************************************************************
+template<typename T>
+void serializer<T>::write(std::ostream& out, const T& value) {
+    detail::write_raw(out, value);
+}
+
+//******************************************************************************
+//* @brief Reads a trivially copyable value back from its bytes.            *
+//******************************************************************************
+template<typename T>
+T serializer<T>::read(std::istream& in) {
+    return detail::read_raw<T>(in);
+}
+
+//******************************************************************************
+//* @brief Copies a trivially copyable value out of mapped memory. The copy *
+//* goes through memcpy, so records need no particular alignment.       *
+//* *
+//* @throws std::runtime_error if fewer than sizeof(T) bytes are left       *
+//* before end.                                                *
+//******************************************************************************
+template<typename T>
+typename serializer<T>::view_type serializer<T>::view(const unsigned char*& p, const unsigned char* end) {
+    detail::check_record_space(p, end, sizeof(T));
+    T value = detail::load_raw<T>(p);
+    p += sizeof(T);
+    return value;
+}
+
+//******************************************************************************
+//* @brief Returns the encoded size of a string: its length field plus its   *
+//* characters.                                                         *
+//******************************************************************************
+inline size_t serializer<std::string>::size(const std::string& value) {
+    return sizeof(uint64_t) + value.size();
+}
+
+//******************************************************************************
+//* @brief Writes a string as its length followed by its characters.        *
+//******************************************************************************
+inline void serializer<std::string>::write(std::ostream& out, const std::string& value) {
+    detail::write_raw(out, static_cast<uint64_t>(value.size()));
+    detail::write_bytes(out, value.data(), value.size());
+}
+
+//******************************************************************************
+//* @brief Reads a length-prefixed string. Long strings are read in chunks, *
+//* so a corrupt length fails at the end of the stream instead of       *
+//* allocating whatever it claims.                                      *
+//******************************************************************************
+inline std::string serializer<std::string>::read(std::istream& in) {
+    constexpr uint64_t CHUNK = 1 << 16;
+    uint64_t length = detail::read_raw<uint64_t>(in);
+    std::string value;
+    for (uint64_t done = 0; done < length;) {
+        size_t n = static_cast<size_t>(std::min(length - done, CHUNK));
+        value.resize(value.size() + n);
+        detail::read_bytes(in, &value[value.size() - n], n);
+        done += n;
+    }
+    return value;
+}
+
+//******************************************************************************
+//* @brief Views a length-prefixed string in mapped memory without copying  *
+//* its characters.                                                     *
+//* *
+//* @throws std::runtime_error if the length field or the characters it    *
+//* announces run past end.                                    *
+//******************************************************************************
+inline serializer<std::string>::view_type serializer<std::string>::view(const unsigned char*& p, const unsigned char* end) {
+    detail::check_record_space(p, end, sizeof(uint64_t));
+    uint64_t length = detail::load_raw<uint64_t>(p);
+    p += sizeof(uint64_t);
+    detail::check_record_space(p, end, length);
+    const char* chars = reinterpret_cast<const char*>(p);
+    p += length;
+    return view_type(chars, static_cast<size_t>(length));
+}
+
+namespace detail {
+
+//******************************************************************************
+//* @brief Builds the header of a new snapshot. The bucket count is the     *
+//* smallest power of two that holds every element at load factor 1.    *
+//* *
+//* @param key_size      serializer<Key>::fixed_size.                        *
+//* @param value_size    serializer<T>::fixed_size.                          *
+//* @param element_count The number of elements to be written.              *
+//******************************************************************************
+inline SnapshotHeader make_snapshot_header(uint64_t key_size, uint64_t value_size, uint64_t element_count) {
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SnapshotHeader::MAGIC, sizeof(header.magic));
+    header.version = SnapshotHeader::VERSION;
+    header.order_mark = SnapshotHeader::ORDER_MARK;
+    header.key_size = key_size;
+    header.value_size = value_size;
+    while ((uint64_t(1) << header.bucket_bits) < element_count) ++header.bucket_bits;
+    header.element_count = element_count;
+    return header;
+}
+
+//******************************************************************************
+//* @brief Rejects a snapshot that was not written by this format version,  *
+//* on a machine of this byte order, for these key and value encodings, *
+//* or whose counts do not fit together.                                *
+//* *
+//* @throws std::runtime_error describing the first mismatch.                *
+//******************************************************************************
+inline void check_snapshot_header(const SnapshotHeader& header, uint64_t key_size, uint64_t value_size) {
+    if (std::memcmp(header.magic, SnapshotHeader::MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("not an UnorderedMap snapshot");
+    }
+    if (header.order_mark != SnapshotHeader::ORDER_MARK) {
+        throw std::runtime_error("snapshot was written with a different byte order");
+    }
+    if (header.version != SnapshotHeader::VERSION) {
+        throw std::runtime_error("unsupported snapshot version");
+    }
+    if (header.key_size != key_size || header.value_size != value_size) {
+        throw std::runtime_error("snapshot key or value layout does not match");
+    }
+    if (header.bucket_bits >= 60) {
+        throw std::runtime_error("snapshot header is corrupt");
+    }
+    // The writer picks the bucket count from the element count, and every
+    // record holds a hash plus the fixed part of its key and value, so
+    // neither count can exceed what records_size has room for.
+    uint64_t min_record = sizeof(uint64_t) + key_size + value_size;
+    if (header.element_count > header.records_size / min_record ||
+        header.bucket_bits != make_snapshot_header(key_size, value_size, header.element_count).bucket_bits ||
+        (key_size != 0 && value_size != 0 && header.records_size != header.element_count * min_record)) {
+        throw std::runtime_error("snapshot header is corrupt");
+    }
+}
+
+//******************************************************************************
+//* @brief Maps a stored hash to its snapshot bucket. The hash is mixed first *
+//* and the top bits are kept, so identity hashes spread as well. The     *
+//* rule is fixed by the format, independent of any map's index policy.  *
+//******************************************************************************
+inline uint64_t snapshot_bucket(uint64_t hash, uint64_t bucket_bits) {
+    if (bucket_bits == 0) return 0;
+    constexpr uint64_t k = 0x9E3779B97F4A7C15ull;
+    uint64_t mixed = (hash * k) ^ mulhi64(hash, k);
+    return mixed >> (64 - bucket_bits);
+}
+
+//******************************************************************************
+//* @brief Checks that a record field of the given size starts at p and     *
+//* ends no later than end.                                             *
+//* *
+//* @throws std::runtime_error if it does not.                              *
+//******************************************************************************
+inline void check_record_space(const unsigned char* p, const unsigned char* end, uint64_t size) {
+    if (p > end || static_cast<uint64_t>(end - p) < size) throw std::runtime_error("snapshot record is corrupt");
+}
+
+//******************************************************************************
+//* @brief Writes bytes straight to the stream buffer. Snapshots write a    *
+//* few bytes per field, and going through ostream::write would build a *
+//* sentry for each of them.                                            *
+//******************************************************************************
+inline void write_bytes(std::ostream& out, const char* data, size_t size) {
+    if (out.rdbuf()->sputn(data, static_cast<std::streamsize>(size)) != static_cast<std::streamsize>(size)) {
+        out.setstate(std::ios::badbit);
+    }
+}
+
+//******************************************************************************
+//* @brief Reads bytes straight from the stream buffer.                      *
+//* *
+//* @throws std::runtime_error if the stream ends first.                     *
+//******************************************************************************
+inline void read_bytes(std::istream& in, char* data, size_t size) {
+    if (in.rdbuf()->sgetn(data, static_cast<std::streamsize>(size)) != static_cast<std::streamsize>(size)) {
+        in.setstate(std::ios::failbit | std::ios::eofbit);
+        throw std::runtime_error("snapshot truncated");
+    }
+}
+
+//******************************************************************************
+//* @brief Skips bytes of the stream. istream::ignore() only sets eofbit   *
+//* when the input runs out, which leaves the stream testing true, so  *
+//* the count actually skipped is checked instead.                       *
+//* *
+//* @throws std::runtime_error if the stream ends first.                     *
+//******************************************************************************
+inline void skip_bytes(std::istream& in, uint64_t size) {
+    in.ignore(static_cast<std::streamsize>(size));
+    if (static_cast<uint64_t>(in.gcount()) != size) {
+        in.setstate(std::ios::failbit | std::ios::eofbit);
+        throw std::runtime_error("snapshot truncated");
+    }
+}
+
+//******************************************************************************
+//* @brief Returns how many bytes the stream holds past its read position,  *
+//* leaving the position unchanged.                                     *
+//* *
+//* @return The byte count, or UINT64_MAX if the stream cannot seek.         *
+//******************************************************************************
+inline uint64_t bytes_left(std::istream& in) {
+    std::streambuf* buf = in.rdbuf();
+    std::streampos pos = buf->pubseekoff(0, std::ios::cur, std::ios::in);
+    if (pos == std::streampos(-1)) return UINT64_MAX;
+    std::streampos end = buf->pubseekoff(0, std::ios::end, std::ios::in);
+    if (buf->pubseekpos(pos, std::ios::in) != pos) {
+        in.setstate(std::ios::failbit);
+        throw std::runtime_error("snapshot stream cannot be repositioned");
+    }
+    if (end == std::streampos(-1) || end < pos) return UINT64_MAX;
+    return static_cast<uint64_t>(end - pos);
+}
+
+//******************************************************************************
+//* @brief Writes the bytes of a trivially copyable value.                   *
+//******************************************************************************
+template<typename T>
+void write_raw(std::ostream& out, const T& value) {
+    write_bytes(out, reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+//******************************************************************************
+//* @brief Reads the bytes of a trivially copyable value.                    *
+//* *
+//* @throws std::runtime_error if the stream ends first.                     *
+//******************************************************************************
+template<typename T>
+T read_raw(std::istream& in) {
+    T value;
+    read_bytes(in, reinterpret_cast<char*>(&value), sizeof(T));
+    return value;
+}
+
+//******************************************************************************
+//* @brief Loads a trivially copyable value from possibly unaligned memory.  *
+//******************************************************************************
+template<typename T>
+T load_raw(const unsigned char* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+} // namespace detail
@@ -0,0 +1,250 @@
+#ifndef SPLIT_UNORDERED_MAP_HPP
+#define SPLIT_UNORDERED_MAP_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "controlGroupHeader.hpp"
+#include "indexPoliciesHeader.hpp"
+#include "statsPolicyHeader.hpp"
+
+namespace detail {
+
+// Contiguous run of elements owned by someone else, as returned by
+// SplitUnorderedMap::keys() and values(); the subset of std::span those
+// scans need.
+template<typename T>
+class Span {
+public:
+    Span() : data_(nullptr), size_(0) {}
+    Span(T* data, size_t size) : data_(data), size_(size) {}
+
+    T* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    T* begin() const { return data_; }
+    T* end() const { return data_ + size_; }
+    T& operator[](size_t i) const { return data_[i]; }
+
+private:
+    T* data_;
+    size_t size_;
+};
+
+// Makes operator-> work for iterators whose reference is a temporary pair.
+template<typename Reference>
+struct ArrowProxy {
+    Reference ref;
+    Reference* operator->() { return &ref; }
+};
+
+} // namespace detail
+
+// Open-addressing map that stores keys, their hashes and the mapped values
+// in three separate dense arrays, with element i of each at index i. The
+// hash index is a control-byte array probed one group at a time, as in
+// FlatStorage, whose slots hold 32-bit element indices. A lookup reads
+// control bytes and keys only, so a miss never brings a mapped value into
+// the cache however large T is, and keys() and values() hand the arrays
+// out whole for vectorised scans. Growing rebuilds only the index from the
+// stored hashes; no element moves. Erasing moves the last element into
+// the hole, so the arrays stay dense without tombstones.
+//
+// Elements are not std::pair objects, so iterators yield
+// std::pair<const Key&, T&> by value. Keys and values must be
+// move-assignable. Insertions invalidate all iterators; erasing invalidates
+// iterators to the erased and the last element.
+template<
+    typename Key,
+    typename T,
+    typename Hash = std::hash<Key>,
+    typename KeyEqual = std::equal_to<Key>,
+    typename IndexPolicy = PowerOfTwoIndex,
+    typename Allocator = std::allocator<std::pair<const Key, T>>
+>
+class SplitUnorderedMap {
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<const Key, T>;
+    using size_type = size_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using allocator_type = Allocator;
+    using index_policy = IndexPolicy;
+    using reference = std::pair<const Key&, T&>;
+    using const_reference = std::pair<const Key&, const T&>;
+
+    class iterator;
+    class const_iterator;
+
+    SplitUnorderedMap(size_type bucket_count = 0,
+                      const Hash& hash = Hash(),
+                      const KeyEqual& equal = KeyEqual(),
+                      const Allocator& alloc = Allocator());
+    SplitUnorderedMap(std::initializer_list<value_type> init,
+                      size_type bucket_count = 0,
+                      const Hash& hash = Hash(),
+                      const KeyEqual& equal = KeyEqual(),
+                      const Allocator& alloc = Allocator());
+
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+    detail::Span<const Key> keys() const;
+    detail::Span<T> values();
+    detail::Span<const T> values() const;
+
+    bool empty() const;
+    size_type size() const;
+    size_type max_size() const;
+
+    void clear();
+    std::pair<iterator,bool> insert(const value_type& kv);
+    std::pair<iterator,bool> insert(value_type&& kv);
+    template<class K, class... Args>
+    std::pair<iterator,bool> emplace(K&& key, Args&&... args);
+    template<class... Args>
+    std::pair<iterator,bool> try_emplace(const Key& key, Args&&... args);
+    template<class... Args>
+    std::pair<iterator,bool> try_emplace(Key&& key, Args&&... args);
+    template<class M>
+    std::pair<iterator,bool> insert_or_assign(const Key& key, M&& obj);
+    template<class M>
+    std::pair<iterator,bool> insert_or_assign(Key&& key, M&& obj);
+    size_type erase(const Key& key);
+    iterator erase(const_iterator pos);
+
+    T& at(const Key& key);
+    const T& at(const Key& key) const;
+    T& operator[](const Key& key);
+    T& operator[](Key&& key);
+    size_type count(const Key& key) const;
+    iterator find(const Key& key);
+    const_iterator find(const Key& key) const;
+    bool contains(const Key& key) const;
+
+    size_type bucket_count() const;
+    float load_factor() const;
+    float max_load_factor() const;
+    void max_load_factor(float ml);
+    void rehash(size_type new_count);
+    void reserve(size_type count);
+
+    hasher hash_function() const;
+    key_equal key_eq() const;
+    allocator_type get_allocator() const;
+    MemoryUsage memory_usage() const;
+
+private:
+    using alloc_traits = std::allocator_traits<Allocator>;
+    using index_type = uint32_t;
+    using key_array = std::vector<Key, typename alloc_traits::template rebind_alloc<Key>>;
+    using mapped_array = std::vector<T, typename alloc_traits::template rebind_alloc<T>>;
+    using hash_array = std::vector<size_type, typename alloc_traits::template rebind_alloc<size_type>>;
+    using ctrl_array = std::vector<detail::ctrl_t, typename alloc_traits::template rebind_alloc<detail::ctrl_t>>;
+    using slot_array = std::vector<index_type, typename alloc_traits::template rebind_alloc<index_type>>;
+    using Group = detail::Group;
+
+    static constexpr size_type DEFAULT_BUCKET_COUNT = 16;
+    static constexpr size_type npos = std::numeric_limits<size_type>::max();
+
+    static size_type mix(size_type hash);
+    static detail::ctrl_t h2(size_type mixed);
+    static size_type max_load(size_type bucket_count, float max_load_factor);
+    size_type capacity() const;
+    const detail::ctrl_t* ctrl() const;
+    size_type home(size_type mixed) const;
+    void set_ctrl(size_type slot, detail::ctrl_t c);
+    size_type find_index(const Key& key, size_type hash) const;
+    size_type slot_of(size_type index) const;
+    void link(size_type index);
+    void unlink(size_type slot);
+    void rebuild(size_type new_count);
+    void grow_if_needed();
+    template<class K, class... Args>
+    std::pair<iterator,bool> emplace_key(K&& key, Args&&... args);
+    void erase_at(size_type index);
+
+    // Element i lives at keys_[i], values_[i] with hash hashes_[i].
+    key_array keys_;
+    mapped_array values_;
+    hash_array hashes_;
+    // Index: one control byte per slot plus a cloned tail of
+    // Group::width - 1, and the element index of each full slot.
+    ctrl_array ctrl_;
+    slot_array slots_;
+    size_type deleted_;
+    float max_load_factor_;
+    Hash hasher_;
+    KeyEqual equal_;
+};
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+class SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::iterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::pair<const Key, T>;
+    using difference_type = std::ptrdiff_t;
+    using reference = SplitUnorderedMap::reference;
+    using pointer = detail::ArrowProxy<reference>;
+
+    iterator() : map_(nullptr), index_(0) {}
+    iterator(SplitUnorderedMap* map, size_type index) : map_(map), index_(index) {}
+
+    iterator& operator++() { ++index_; return *this; }
+    iterator operator++(int) { iterator old = *this; ++index_; return old; }
+    reference operator*() const { return { map_->keys_[index_], map_->values_[index_] }; }
+    pointer operator->() const { return { **this }; }
+    bool operator==(const iterator& o) const { return map_ == o.map_ && index_ == o.index_; }
+    bool operator!=(const iterator& o) const { return !(*this == o); }
+
+private:
+    friend class SplitUnorderedMap;
+    friend class const_iterator;
+
+    SplitUnorderedMap* map_;
+    size_type index_;
+};
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+class SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::const_iterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::pair<const Key, T>;
+    using difference_type = std::ptrdiff_t;
+    using reference = SplitUnorderedMap::const_reference;
+    using pointer = detail::ArrowProxy<reference>;
+
+    const_iterator() : map_(nullptr), index_(0) {}
+    const_iterator(const SplitUnorderedMap* map, size_type index) : map_(map), index_(index) {}
+    const_iterator(const iterator& it) : map_(it.map_), index_(it.index_) {}
+
+    const_iterator& operator++() { ++index_; return *this; }
+    const_iterator operator++(int) { const_iterator old = *this; ++index_; return old; }
+    reference operator*() const { return { map_->keys_[index_], map_->values_[index_] }; }
+    pointer operator->() const { return { **this }; }
+    bool operator==(const const_iterator& o) const { return map_ == o.map_ && index_ == o.index_; }
+    bool operator!=(const const_iterator& o) const { return !(*this == o); }
+
+private:
+    friend class SplitUnorderedMap;
+
+    const SplitUnorderedMap* map_;
+    size_type index_;
+};
+
+#include "splitUnorderedMapImplementation.tpp"
+
+#endif
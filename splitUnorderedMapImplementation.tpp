@@ -0,0 +1,687 @@
+#include "splitUnorderedMapHeader.hpp"
+
+//******************************************************************************
+//* @brief Constructs an empty map. Nothing is allocated unless              *
+//* bucket_count is non-zero.                                                *
+//* *
+//* @param bucket_count Index slots to allocate up front.                    *
+//* @param hash         The hash function.                                   *
+//* @param equal        The key equality predicate.                          *
+//* @param alloc        The allocator; rebound for each array.               *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::SplitUnorderedMap(size_type bucket_count, const Hash& hash, const KeyEqual& equal, const Allocator& alloc)
+    : keys_(typename key_array::allocator_type(alloc)), values_(typename mapped_array::allocator_type(alloc)),
+      hashes_(typename hash_array::allocator_type(alloc)), ctrl_(typename ctrl_array::allocator_type(alloc)),
+      slots_(typename slot_array::allocator_type(alloc)), deleted_(0), max_load_factor_(0.875f),
+      hasher_(hash), equal_(equal) {
+    if (bucket_count != 0) rebuild(bucket_count);
+}
+
+//******************************************************************************
+//* @brief Constructs a map from an initializer list, sizing the arrays      *
+//* and the index once for all of its elements.                              *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::SplitUnorderedMap(std::initializer_list<value_type> init, size_type bucket_count, const Hash& hash,
+                                                  const KeyEqual& equal, const Allocator& alloc)
+    : SplitUnorderedMap(bucket_count, hash, equal, alloc) {
+    reserve(init.size());
+    for (const value_type& kv : init) insert(kv);
+}
+
+//******************************************************************************
+//* @brief Returns an iterator to the first element, index 0 of the arrays.  *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::iterator SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::begin() {
+    return iterator(this, 0);
+}
+
+//******************************************************************************
+//* @brief Returns the past-the-end iterator.                                *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::iterator SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::end() {
+    return iterator(this, keys_.size());
+}
+
+//******************************************************************************
+//* @brief Returns a const iterator to the first element.                    *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::const_iterator SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::begin() const {
+    return const_iterator(this, 0);
+}
+
+//******************************************************************************
+//* @brief Returns the past-the-end const iterator.                          *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::const_iterator SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::end() const {
+    return const_iterator(this, keys_.size());
+}
+
+//******************************************************************************
+//* @brief Returns the dense key array: size() keys, in iteration order.     *
+//* Valid until the next insertion or erasure.                               *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+detail::Span<const Key> SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::keys() const {
+    return { keys_.data(), keys_.size() };
+}
+
+//******************************************************************************
+//* @brief Returns the dense value array; values()[i] is the value of        *
+//* keys()[i]. Values may be modified in place.                              *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+detail::Span<T> SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::values() {
+    return { values_.data(), values_.size() };
+}
+
+//******************************************************************************
+//* @brief Returns the dense value array (const version).                    *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+detail::Span<const T> SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::values() const {
+    return { values_.data(), values_.size() };
+}
+
+//******************************************************************************
+//* @brief Checks whether the map is empty.                                  *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+bool SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::empty() const {
+    return keys_.empty();
+}
+
+//******************************************************************************
+//* @brief Returns the number of elements.                                   *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::size_type SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::size() const {
+    return keys_.size();
+}
+
+//******************************************************************************
+//* @brief Returns the largest possible number of elements, bounded by the   *
+//* 32-bit element indices of the hash index.                                *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::size_type SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::max_size() const {
+    size_type limit = std::numeric_limits<index_type>::max();
+    return keys_.max_size() < limit ? keys_.max_size() : limit;
+}
+
+//******************************************************************************
+//* @brief Removes every element. The arrays and the index keep their        *
+//* capacity.                                                                *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+void SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::clear() {
+    keys_.clear();
+    values_.clear();
+    hashes_.clear();
+    std::fill(ctrl_.begin(), ctrl_.end(), detail::CTRL_EMPTY);
+    deleted_ = 0;
+}
+
+//******************************************************************************
+//* @brief Inserts a copy of kv if its key is not present yet.               *
+//* *
+//* @return An iterator to the element with kv's key and whether it was      *
+//* inserted.                                                                *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+std::pair<typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::iterator, bool>
+SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::insert(const value_type& kv) {
+    return emplace_key(kv.first, kv.second);
+}
+
+//******************************************************************************
+//* @brief Inserts kv if its key is not present yet, moving its value.       *
+//* The key is copied: value_type holds it as const.                         *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+std::pair<typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::iterator, bool>
+SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::insert(value_type&& kv) {
+    return emplace_key(kv.first, std::move(kv.second));
+}
+
+//******************************************************************************
+//* @brief Inserts an element if the key is not present yet. Unlike          *
+//* std::unordered_map::emplace, the first argument is the key and the       *
+//* rest construct the mapped value, since the two are stored apart.         *
+//* *
+//* @param key  The key, or an argument to construct it from.                *
+//* @param args Arguments forwarded to the constructor of T.                 *
+//* @return An iterator to the element with the key and whether it was       *
+//* inserted.                                                                *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+template<class K, class... Args>
+std::pair<typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::iterator, bool>
+SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::emplace(K&& key, Args&&... args) {
+    if constexpr (std::is_same<std::remove_cv_t<std::remove_reference_t<K>>, Key>::value) {
+        return emplace_key(std::forward<K>(key), std::forward<Args>(args)...);
+    } else {
+        return emplace_key(Key(std::forward<K>(key)), std::forward<Args>(args)...);
+    }
+}
+
+//******************************************************************************
+//* @brief Inserts an element with the given key and a value constructed     *
+//* from args, unless the key exists; then args are left untouched.          *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+template<class... Args>
+std::pair<typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::iterator, bool>
+SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::try_emplace(const Key& key, Args&&... args) {
+    return emplace_key(key, std::forward<Args>(args)...);
+}
+
+//******************************************************************************
+//* @brief Inserts an element moving the key into the map, unless the        *
+//* key exists; then key and args are left untouched.                        *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+template<class... Args>
+std::pair<typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::iterator, bool>
+SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::try_emplace(Key&& key, Args&&... args) {
+    return emplace_key(std::move(key), std::forward<Args>(args)...);
+}
+
+//******************************************************************************
+//* @brief Assigns obj to the value of key, or inserts it under key.         *
+//* *
+//* @return An iterator to the element and true if it was inserted.          *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+template<class M>
+std::pair<typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::iterator, bool>
+SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::insert_or_assign(const Key& key, M&& obj) {
+    auto res = emplace_key(key, std::forward<M>(obj));
+    if (!res.second) values_[res.first.index_] = std::forward<M>(obj);
+    return res;
+}
+
+//******************************************************************************
+//* @brief Assigns obj to the value of key, or inserts it moving key in.     *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+template<class M>
+std::pair<typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::iterator, bool>
+SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::insert_or_assign(Key&& key, M&& obj) {
+    auto res = emplace_key(std::move(key), std::forward<M>(obj));
+    if (!res.second) values_[res.first.index_] = std::forward<M>(obj);
+    return res;
+}
+
+//******************************************************************************
+//* @brief Erases the element with the given key, if any.                    *
+//* *
+//* @return The number of elements erased (0 or 1).                          *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::size_type SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::erase(const Key& key) {
+    size_type index = find_index(key, hasher_(key));
+    if (index == npos) return 0;
+    erase_at(index);
+    return 1;
+}
+
+//******************************************************************************
+//* @brief Erases the element an iterator points to. The last element        *
+//* takes its place, so the returned iterator, at the same position,         *
+//* refers to that element and a loop erasing as it goes still visits        *
+//* every element once.                                                      *
+//* *
+//* @param pos An iterator to the element to erase; must be dereferenceable. *
+//* @return An iterator to the element now at pos, or end().                 *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::iterator SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::erase(const_iterator pos) {
+    erase_at(pos.index_);
+    return iterator(this, pos.index_);
+}
+
+//******************************************************************************
+//* @brief Returns the value of key.                                         *
+//* *
+//* @throws std::out_of_range If the key is not found in the map.            *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+T& SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::at(const Key& key) {
+    size_type index = find_index(key, hasher_(key));
+    if (index == npos) throw std::out_of_range("Key not found");
+    return values_[index];
+}
+
+//******************************************************************************
+//* @brief Returns the value of key (const version).                         *
+//* *
+//* @throws std::out_of_range If the key is not found in the map.            *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+const T& SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::at(const Key& key) const {
+    size_type index = find_index(key, hasher_(key));
+    if (index == npos) throw std::out_of_range("Key not found");
+    return values_[index];
+}
+
+//******************************************************************************
+//* @brief Returns the value of key, inserting a value-initialized one       *
+//* first if the key is absent.                                              *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+T& SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::operator[](const Key& key) {
+    return values_[emplace_key(key).first.index_];
+}
+
+//******************************************************************************
+//* @brief Returns the value of key, moving the key into the map if it       *
+//* is absent.                                                               *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+T& SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::operator[](Key&& key) {
+    return values_[emplace_key(std::move(key)).first.index_];
+}
+
+//******************************************************************************
+//* @brief Returns the number of elements with the key (0 or 1).             *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::size_type SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::count(const Key& key) const {
+    return find_index(key, hasher_(key)) != npos;
+}
+
+//******************************************************************************
+//* @brief Finds the element with the given key.                             *
+//* *
+//* @return An iterator to the element, or end() if the key is not found.    *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::iterator SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::find(const Key& key) {
+    size_type index = find_index(key, hasher_(key));
+    return iterator(this, index == npos ? keys_.size() : index);
+}
+
+//******************************************************************************
+//* @brief Finds the element with the given key (const version).             *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::const_iterator SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::find(const Key& key) const {
+    size_type index = find_index(key, hasher_(key));
+    return const_iterator(this, index == npos ? keys_.size() : index);
+}
+
+//******************************************************************************
+//* @brief Checks whether the map holds the key.                             *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+bool SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::contains(const Key& key) const {
+    return find_index(key, hasher_(key)) != npos;
+}
+
+//******************************************************************************
+//* @brief Returns the number of slots in the hash index.                    *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::size_type SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::bucket_count() const {
+    return capacity();
+}
+
+//******************************************************************************
+//* @brief Returns the number of elements per index slot.                    *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+float SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::load_factor() const {
+    return capacity() == 0 ? 0.0f : static_cast<float>(keys_.size()) / static_cast<float>(capacity());
+}
+
+//******************************************************************************
+//* @brief Returns the load factor at which the index grows.                 *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+float SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::max_load_factor() const {
+    return max_load_factor_;
+}
+
+//******************************************************************************
+//* @brief Sets the load factor at which the index grows, growing it now     *
+//* if the elements no longer fit. An unallocated index stays so.           *
+//* *
+//* @throws std::invalid_argument if ml is not a positive finite number. *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+void SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::max_load_factor(float ml) {
+    if (!(ml > 0.0f && ml <= std::numeric_limits<float>::max()))
+        throw std::invalid_argument("max_load_factor must be positive and finite");
+    max_load_factor_ = ml;
+    if (capacity() != 0 && keys_.size() + deleted_ >= max_load(capacity(), max_load_factor_)) rehash(capacity());
+}
+
+//******************************************************************************
+//* @brief Rebuilds the index with at least new_count slots, more if the     *
+//* elements would not fit under max_load_factor(). Only the index is        *
+//* rebuilt, from the stored hashes: no key is hashed and no element         *
+//* moves.                                                                   *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+void SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::rehash(size_type new_count) {
+    if (new_count == 0) new_count = 1;
+    while (keys_.size() > max_load(new_count, max_load_factor_)) new_count *= 2;
+    rebuild(new_count);
+}
+
+//******************************************************************************
+//* @brief Reserves room for count elements in all three arrays and in       *
+//* the index, so that inserting up to count elements neither                *
+//* reallocates an array nor rebuilds the index.                             *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+void SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::reserve(size_type count) {
+    keys_.reserve(count);
+    values_.reserve(count);
+    hashes_.reserve(count);
+    if (count + deleted_ <= max_load(capacity(), max_load_factor_)) return;
+    size_type new_count = static_cast<size_type>(static_cast<double>(count) / max_load_factor_);
+    if (new_count == 0) new_count = 1;
+    while (max_load(new_count, max_load_factor_) < count) ++new_count;
+    rebuild(new_count < capacity() ? capacity() : new_count);
+}
+
+//******************************************************************************
+//* @brief Returns the hash function.                                        *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::hasher SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::hash_function() const {
+    return hasher_;
+}
+
+//******************************************************************************
+//* @brief Returns the key equality predicate.                               *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::key_equal SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::key_eq() const {
+    return equal_;
+}
+
+//******************************************************************************
+//* @brief Returns the allocator the arrays were rebound from.               *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::allocator_type SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::get_allocator() const {
+    return allocator_type(keys_.get_allocator());
+}
+
+//******************************************************************************
+//* @brief Reports the memory held by the map object, the three dense        *
+//* arrays and the index. Heap memory owned by the keys or values            *
+//* themselves is not counted.                                               *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+MemoryUsage SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::memory_usage() const {
+    MemoryUsage usage;
+    usage.table = sizeof(*this) + keys_.capacity() * sizeof(Key) + values_.capacity() * sizeof(T) +
+                  hashes_.capacity() * sizeof(size_type) + ctrl_.capacity() * sizeof(detail::ctrl_t) +
+                  slots_.capacity() * sizeof(index_type);
+    usage.allocations = (keys_.capacity() != 0) + (values_.capacity() != 0) + (hashes_.capacity() != 0) +
+                        (ctrl_.capacity() != 0) + (slots_.capacity() != 0);
+    return usage;
+}
+
+//******************************************************************************
+//* @brief Mixes a hash before it picks a home slot or a tag. As in        *
+//* FlatStorage this is always mix_hash, whatever the index policy's   *
+//* own mix(), since linear probing cannot afford the clustered home   *
+//* slots of an identity hash.                                          *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::size_type SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::mix(size_type hash) {
+    return detail::mix_hash(hash);
+}
+
+//******************************************************************************
+//* @brief Returns the seven hash bits kept in a full slot's control byte.   *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+detail::ctrl_t SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::h2(size_type mixed) {
+    if (IndexPolicy::high_bits_index) return static_cast<detail::ctrl_t>(mixed & 0x7F);
+    return static_cast<detail::ctrl_t>(mixed >> (sizeof(size_type) * 8 - 7));
+}
+
+//******************************************************************************
+//* @brief Returns how many elements fit in bucket_count slots, always       *
+//* leaving one slot empty so that every probe terminates.                   *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::size_type SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::max_load(size_type bucket_count, float max_load_factor) {
+    if (bucket_count == 0) return 0;
+    size_type limit = static_cast<size_type>(bucket_count * max_load_factor);
+    return limit < bucket_count ? limit : bucket_count - 1;
+}
+
+//******************************************************************************
+//* @brief Returns the number of index slots. It is not stored separately, *
+//* so a moved-from map, whose arrays are empty, is consistent as it is. *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::size_type SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::capacity() const {
+    return slots_.size();
+}
+
+//******************************************************************************
+//* @brief Returns the control bytes: the shared EMPTY_GROUP while the       *
+//* index has no slots, so that a lookup still loads one empty group.        *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+const detail::ctrl_t* SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::ctrl() const {
+    return capacity() == 0 ? detail::EMPTY_GROUP : ctrl_.data();
+}
+
+//******************************************************************************
+//* @brief Returns the slot where the probe sequence of a mixed hash starts. *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::size_type SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::home(size_type mixed) const {
+    return IndexPolicy::index(mixed, capacity() + (capacity() == 0));
+}
+
+//******************************************************************************
+//* @brief Writes a control byte, mirroring it into the cloned tail when the *
+//* slot is one of the first Group::width - 1.                               *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+void SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::set_ctrl(size_type slot, detail::ctrl_t c) {
+    ctrl_[slot] = c;
+    if (slot < Group::width - 1) ctrl_[capacity() + slot] = c;
+}
+
+//******************************************************************************
+//* @brief Probes the index for a key. Only control bytes, slot indices      *
+//* and the keys behind matching tags are read; the tags reject all          *
+//* but one in 128 other elements before a key is compared.                  *
+//* *
+//* @return The element index of the key, or npos.                           *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::size_type SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::find_index(const Key& key, size_type hash) const {
+    size_type mixed = mix(hash);
+    size_type pos = home(mixed);
+    detail::ctrl_t tag = h2(mixed);
+    const detail::ctrl_t* c = ctrl();
+    while (true) {
+        Group group(c + pos);
+        for (auto match = group.match(tag); match; match.clear_lowest()) {
+            size_type slot = pos + match.lowest();
+            if (slot >= capacity()) slot -= capacity();
+            size_type index = slots_[slot];
+            if (equal_(keys_[index], key)) return index;
+        }
+        if (group.match_empty()) return npos;
+        pos += Group::width;
+        if (pos >= capacity()) pos -= capacity();
+    }
+}
+
+//******************************************************************************
+//* @brief Returns the index slot that refers to an element, found by        *
+//* probing with its stored hash and comparing indices, not keys.            *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::size_type SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::slot_of(size_type index) const {
+    size_type mixed = mix(hashes_[index]);
+    size_type pos = home(mixed);
+    detail::ctrl_t tag = h2(mixed);
+    while (true) {
+        for (auto match = Group(ctrl_.data() + pos).match(tag); match; match.clear_lowest()) {
+            size_type slot = pos + match.lowest();
+            if (slot >= capacity()) slot -= capacity();
+            if (slots_[slot] == index) return slot;
+        }
+        pos += Group::width;
+        if (pos >= capacity()) pos -= capacity();
+    }
+}
+
+//******************************************************************************
+//* @brief Enters an element into the index, in the first empty or           *
+//* deleted slot of its probe sequence.                                      *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+void SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::link(size_type index) {
+    size_type mixed = mix(hashes_[index]);
+    size_type pos = home(mixed);
+    while (true) {
+        auto free = Group(ctrl_.data() + pos).match_empty_or_deleted();
+        if (free) {
+            size_type slot = pos + free.lowest();
+            if (slot >= capacity()) slot -= capacity();
+            if (ctrl_[slot] == detail::CTRL_DELETED) --deleted_;
+            set_ctrl(slot, h2(mixed));
+            slots_[slot] = static_cast<index_type>(index);
+            return;
+        }
+        pos += Group::width;
+        if (pos >= capacity()) pos -= capacity();
+    }
+}
+
+//******************************************************************************
+//* @brief Frees an index slot. As in FlatStorage, it becomes empty again    *
+//* only if no probe can have passed through it, and is marked deleted       *
+//* otherwise.                                                               *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+void SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::unlink(size_type slot) {
+    size_type before = slot >= Group::width ? slot - Group::width : slot + capacity() - Group::width;
+    auto empty_after = Group(ctrl_.data() + slot).match_empty();
+    auto empty_before = Group(ctrl_.data() + before).match_empty();
+    bool was_never_full = empty_before && empty_after &&
+        static_cast<size_type>(empty_after.trailing_zeros() + empty_before.leading_zeros()) < Group::width;
+    if (was_never_full) {
+        set_ctrl(slot, detail::CTRL_EMPTY);
+    } else {
+        set_ctrl(slot, detail::CTRL_DELETED);
+        ++deleted_;
+    }
+}
+
+//******************************************************************************
+//* @brief Replaces the index with one of new_count slots, rounded by the    *
+//* index policy and up to one group, and links every element into it        *
+//* from its stored hash. The new arrays are allocated before the old        *
+//* ones are released, so a failed allocation leaves the map intact.         *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+void SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::rebuild(size_type new_count) {
+    new_count = IndexPolicy::bucket_count_for(new_count);
+    if (new_count < Group::width) new_count = Group::width;
+    ctrl_array ctrl(new_count + Group::width - 1, detail::CTRL_EMPTY, ctrl_.get_allocator());
+    slot_array slots(new_count, 0, slots_.get_allocator());
+    ctrl_.swap(ctrl);
+    slots_.swap(slots);
+    deleted_ = 0;
+    for (size_type i = 0; i < keys_.size(); ++i) link(i);
+}
+
+//******************************************************************************
+//* @brief Makes room in the index for one more element, as UnorderedMap     *
+//* does for flat storage: tombstones are reclaimed at the current size      *
+//* while the elements leave an eighth of the limit free, and the index      *
+//* doubles otherwise.                                                       *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+void SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::grow_if_needed() {
+    size_type size = keys_.size();
+    size_type limit = max_load(capacity(), max_load_factor_);
+    if (size + deleted_ < limit) return;
+    if (deleted_ != 0 && size < limit - limit / 8) {
+        rebuild(capacity());
+        return;
+    }
+    size_type count = capacity();
+    if (count == 0) count = DEFAULT_BUCKET_COUNT;
+    else if (size < limit) count *= 2;
+    while (size >= max_load(count, max_load_factor_)) count *= 2;
+    rebuild(count);
+}
+
+//******************************************************************************
+//* @brief Common insertion path. Looks the key up and, if it is absent,     *
+//* appends it, its hash and a value constructed from args to the three      *
+//* arrays and links the new index into the hash index. If constructing      *
+//* the value throws, the key and hash are popped again.                     *
+//* *
+//* @param key  The key; copied or moved into the key array.                 *
+//* @param args Arguments forwarded to the constructor of T.                 *
+//* @return An iterator to the element with the key and whether it was       *
+//* inserted.                                                                *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+template<class K, class... Args>
+std::pair<typename SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::iterator, bool>
+SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::emplace_key(K&& key, Args&&... args) {
+    size_type hash = hasher_(key);
+    size_type index = find_index(key, hash);
+    if (index != npos) return { iterator(this, index), false };
+    index = keys_.size();
+    if (index == max_size()) throw std::length_error("SplitUnorderedMap is full");
+    grow_if_needed();
+    hashes_.push_back(hash);
+    try {
+        keys_.emplace_back(std::forward<K>(key));
+        try {
+            values_.emplace_back(std::forward<Args>(args)...);
+        } catch (...) {
+            keys_.pop_back();
+            throw;
+        }
+    } catch (...) {
+        hashes_.pop_back();
+        throw;
+    }
+    link(index);
+    return { iterator(this, index), true };
+}
+
+//******************************************************************************
+//* @brief Removes element index: unlinks it, moves the last element into    *
+//* its place and relinks that element's slot to the new index.              *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename IndexPolicy, typename Allocator>
+void SplitUnorderedMap<Key, T, Hash, KeyEqual, IndexPolicy, Allocator>::erase_at(size_type index) {
+    size_type last = keys_.size() - 1;
+    unlink(slot_of(index));
+    if (index != last) {
+        slots_[slot_of(last)] = static_cast<index_type>(index);
+        keys_[index] = std::move(keys_[last]);
+        values_[index] = std::move(values_[last]);
+        hashes_[index] = hashes_[last];
+    }
+    keys_.pop_back();
+    values_.pop_back();
+    hashes_.pop_back();
+}
@@ -0,0 +1,99 @@
+#ifndef STATIC_UNORDERED_MAP_HPP
+#define STATIC_UNORDERED_MAP_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "indexPoliciesHeader.hpp"
+
+// Hash functions usable in constant expressions, for StaticUnorderedMap.
+// Integers and enums hash to their value, which the map mixes anyway;
+// strings are hashed a word at a time.
+template<typename Key, typename = void>
+struct static_hash;
+
+template<typename Key>
+struct static_hash<Key, std::enable_if_t<std::is_integral<Key>::value || std::is_enum<Key>::value>> {
+    constexpr uint64_t operator()(Key key) const;
+};
+
+template<>
+struct static_hash<std::string_view> {
+    constexpr uint64_t operator()(std::string_view key) const;
+};
+
+namespace detail {
+
+constexpr uint64_t static_mix(uint64_t hash, uint64_t seed);
+
+} // namespace detail
+
+// Immutable map over a key set fixed at compile time. Construction, which
+// make_static_map() runs in a constant expression, builds a minimal
+// perfect hash by hash-and-displace (CHD): keys are grouped into N buckets
+// by their hash, and each bucket, largest first, gets the first seed that
+// sends all of its keys to distinct free slots; single-key buckets store
+// their slot directly. A lookup is then one hash of the key, one table
+// read and one key comparison, with no chains, probing or division, and a
+// constexpr map lives entirely in read-only data.
+template<typename Key, typename T, size_t N, typename Hash = static_hash<Key>>
+class StaticUnorderedMap {
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<const Key, T>;
+    using size_type = size_t;
+    using hasher = Hash;
+    using iterator = const value_type*;
+    using const_iterator = const value_type*;
+
+    constexpr StaticUnorderedMap(const std::pair<Key, T> (&items)[N], const Hash& hash = Hash());
+
+    constexpr const_iterator begin() const;
+    constexpr const_iterator end() const;
+    constexpr bool empty() const;
+    constexpr size_type size() const;
+
+    constexpr const_iterator find(const Key& key) const;
+    constexpr bool contains(const Key& key) const;
+    constexpr size_type count(const Key& key) const;
+    constexpr const mapped_type& at(const Key& key) const;
+
+private:
+    // Per bucket: the seed that places its keys, or -(slot + 1) for a
+    // bucket holding a single key.
+    using displacement_array = std::array<int64_t, N>;
+
+    struct Layout {
+        displacement_array displacement;
+        // Index into the input of the item placed in each slot.
+        std::array<size_t, N> item_at;
+    };
+
+    static constexpr size_type reduce(uint64_t hash);
+    static constexpr Layout build(const std::pair<Key, T> (&items)[N], const Hash& hash);
+    template<size_t... I>
+    constexpr StaticUnorderedMap(const std::pair<Key, T> (&items)[N], const Hash& hash,
+                                 const Layout& layout, std::index_sequence<I...>);
+    constexpr size_type slot_for(uint64_t hash) const;
+
+    Hash hasher_;
+    displacement_array displacement_;
+    std::array<value_type, N> slots_;
+};
+
+// Builds a StaticUnorderedMap from a braced list of key-value pairs. Call
+// it in a constexpr context so that the perfect hash is found at compile
+// time; a duplicate key then fails compilation.
+//   static constexpr auto ops = make_static_map<std::string_view, int>({{"add", 1}, {"sub", 2}});
+template<typename Key, typename T, size_t N, typename Hash = static_hash<Key>>
+constexpr StaticUnorderedMap<Key, T, N, Hash> make_static_map(const std::pair<Key, T> (&items)[N], const Hash& hash = Hash());
+
+#include "staticUnorderedMapImplementation.tpp"
+
+#endif
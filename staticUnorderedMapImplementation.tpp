@@ -0,0 +1,265 @@
+#include "staticUnorderedMapHeader.hpp"
+
+//******************************************************************************
+//* @brief Hashes an integer or enum to its value. StaticUnorderedMap mixes *
+//* every hash before use, so the identity is enough.                   *
+//******************************************************************************
+template<typename Key>
+constexpr uint64_t static_hash<Key, std::enable_if_t<std::is_integral<Key>::value || std::is_enum<Key>::value>>::operator()(Key key) const {
+    if constexpr (std::is_enum<Key>::value) {
+        return static_cast<uint64_t>(static_cast<std::underlying_type_t<Key>>(key));
+    } else {
+        return static_cast<uint64_t>(key);
+    }
+}
+
+//******************************************************************************
+//* @brief Hashes a string eight bytes at a time: each little-endian word is *
+//* folded in with a 64x64->128-bit multiply, and the tail is padded with *
+//* zeros. The byte-wise word assembly is a single load once optimised, *
+//* but stays valid in constant expressions.                            *
+//******************************************************************************
+constexpr uint64_t static_hash<std::string_view>::operator()(std::string_view key) const {
+    constexpr uint64_t k = 0x9E3779B97F4A7C15ull;
+    auto fold = [](uint64_t h, uint64_t word) {
+        uint64_t x = h ^ word;
+        return (x * k) ^ detail::mulhi64(x, k);
+    };
+    auto word_at = [&](size_t i, size_t n) {
+        uint64_t word = 0;
+        for (size_t b = 0; b < n; ++b) word |= static_cast<uint64_t>(static_cast<unsigned char>(key[i + b])) << (8 * b);
+        return word;
+    };
+    uint64_t hash = k ^ key.size();
+    size_t i = 0;
+    for (; i + 8 <= key.size(); i += 8) hash = fold(hash, word_at(i, 8));
+    return fold(hash, word_at(i, key.size() - i));
+}
+
+namespace detail {
+
+//******************************************************************************
+//* @brief Derives a well-mixed 64-bit value from a hash and a seed with the *
+//* SplitMix64 finalizer. Seed 0 picks a key's bucket; the seeds found  *
+//* for each bucket pick slots.                                         *
+//******************************************************************************
+constexpr uint64_t static_mix(uint64_t hash, uint64_t seed) {
+    uint64_t x = hash ^ (seed * 0x9E3779B97F4A7C15ull);
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+} // namespace detail
+
+//******************************************************************************
+//* @brief Builds the perfect hash for a set of items and places each item  *
+//* in its slot.                                                        *
+//* *
+//* @param items The key-value pairs; keys must be distinct.                *
+//* @param hash  The hash function.                                          *
+//* @throws std::invalid_argument on a duplicate key, or on two keys whose   *
+//* 64-bit hashes collide. Either fails compilation when the   *
+//* map is built in a constant expression.                     *
+//******************************************************************************
+template<typename Key, typename T, size_t N, typename Hash>
+constexpr StaticUnorderedMap<Key, T, N, Hash>::StaticUnorderedMap(const std::pair<Key, T> (&items)[N], const Hash& hash)
+    : StaticUnorderedMap(items, hash, build(items, hash), std::make_index_sequence<N>()) {}
+
+//******************************************************************************
+//* @brief Copies the items into the slots chosen by build().               *
+//******************************************************************************
+template<typename Key, typename T, size_t N, typename Hash>
+template<size_t... I>
+constexpr StaticUnorderedMap<Key, T, N, Hash>::StaticUnorderedMap(const std::pair<Key, T> (&items)[N], const Hash& hash,
+                                                                   const Layout& layout, std::index_sequence<I...>)
+    : hasher_(hash), displacement_(layout.displacement),
+      slots_{ { value_type(items[layout.item_at[I]].first, items[layout.item_at[I]].second)... } } {}
+
+//******************************************************************************
+//* @brief Returns the first slot.                                           *
+//******************************************************************************
+template<typename Key, typename T, size_t N, typename Hash>
+constexpr typename StaticUnorderedMap<Key, T, N, Hash>::const_iterator StaticUnorderedMap<Key, T, N, Hash>::begin() const {
+    return slots_.data();
+}
+
+//******************************************************************************
+//* @brief Returns the past-the-end slot.                                    *
+//******************************************************************************
+template<typename Key, typename T, size_t N, typename Hash>
+constexpr typename StaticUnorderedMap<Key, T, N, Hash>::const_iterator StaticUnorderedMap<Key, T, N, Hash>::end() const {
+    return slots_.data() + N;
+}
+
+//******************************************************************************
+//* @brief Returns true if the map has no elements.                          *
+//******************************************************************************
+template<typename Key, typename T, size_t N, typename Hash>
+constexpr bool StaticUnorderedMap<Key, T, N, Hash>::empty() const {
+    return N == 0;
+}
+
+//******************************************************************************
+//* @brief Returns the number of elements, which is also the number of slots. *
+//******************************************************************************
+template<typename Key, typename T, size_t N, typename Hash>
+constexpr typename StaticUnorderedMap<Key, T, N, Hash>::size_type StaticUnorderedMap<Key, T, N, Hash>::size() const {
+    return N;
+}
+
+//******************************************************************************
+//* @brief Looks up a key. The perfect hash names the only slot the key can *
+//* be in, so there is exactly one key comparison.                       *
+//* *
+//* @param key The key to search for.                                        *
+//* @return An iterator to the element, or end() if key is not in the map.  *
+//******************************************************************************
+template<typename Key, typename T, size_t N, typename Hash>
+constexpr typename StaticUnorderedMap<Key, T, N, Hash>::const_iterator StaticUnorderedMap<Key, T, N, Hash>::find(const Key& key) const {
+    const value_type& slot = slots_[slot_for(hasher_(key))];
+    return slot.first == key ? &slot : end();
+}
+
+//******************************************************************************
+//* @brief Returns true if the map contains the key.                         *
+//******************************************************************************
+template<typename Key, typename T, size_t N, typename Hash>
+constexpr bool StaticUnorderedMap<Key, T, N, Hash>::contains(const Key& key) const {
+    return find(key) != end();
+}
+
+//******************************************************************************
+//* @brief Returns the number of elements with the key (either 0 or 1).      *
+//******************************************************************************
+template<typename Key, typename T, size_t N, typename Hash>
+constexpr typename StaticUnorderedMap<Key, T, N, Hash>::size_type StaticUnorderedMap<Key, T, N, Hash>::count(const Key& key) const {
+    return contains(key) ? 1 : 0;
+}
+
+//******************************************************************************
+//* @brief Accesses the value of the specified key.                          *
+//* *
+//* @param key The key of the element to access.                             *
+//* @return A reference to the mapped value.                                 *
+//* @throws std::out_of_range If the key is not found in the map.              *
+//******************************************************************************
+template<typename Key, typename T, size_t N, typename Hash>
+constexpr const typename StaticUnorderedMap<Key, T, N, Hash>::mapped_type& StaticUnorderedMap<Key, T, N, Hash>::at(const Key& key) const {
+    auto it = find(key);
+    if (it == end()) throw std::out_of_range("Key not found");
+    return it->second;
+}
+
+//******************************************************************************
+//* @brief Maps a mixed hash to [0, N) with a multiply instead of a modulo.  *
+//******************************************************************************
+template<typename Key, typename T, size_t N, typename Hash>
+constexpr typename StaticUnorderedMap<Key, T, N, Hash>::size_type StaticUnorderedMap<Key, T, N, Hash>::reduce(uint64_t hash) {
+    return static_cast<size_type>(detail::mulhi64(hash, N));
+}
+
+//******************************************************************************
+//* @brief Finds the perfect hash. Items are grouped into buckets with a   *
+//* counting sort. Buckets of two or more keys are placed largest first,  *
+//* while most slots are still free: each tries seeds 1, 2, ... until its *
+//* keys land on distinct free slots. Single-key buckets go last, into   *
+//* whatever slots remain, and need no seed. With N buckets for N keys   *
+//* the largest buckets hold a handful of keys, so a few seeds suffice.   *
+//******************************************************************************
+template<typename Key, typename T, size_t N, typename Hash>
+constexpr typename StaticUnorderedMap<Key, T, N, Hash>::Layout
+StaticUnorderedMap<Key, T, N, Hash>::build(const std::pair<Key, T> (&items)[N], const Hash& hash) {
+    Layout layout{};
+    std::array<uint64_t, N> hashes{};
+    std::array<size_t, N> bucket_of{};
+    std::array<size_t, N + 1> start{};
+    for (size_t i = 0; i < N; ++i) {
+        hashes[i] = hash(items[i].first);
+        bucket_of[i] = reduce(detail::static_mix(hashes[i], 0));
+        ++start[bucket_of[i] + 1];
+    }
+    size_t largest = 0;
+    for (size_t b = 0; b < N; ++b) {
+        if (start[b + 1] > largest) largest = start[b + 1];
+        start[b + 1] += start[b];
+    }
+    std::array<size_t, N> members{};
+    std::array<size_t, N> next{};
+    for (size_t b = 0; b < N; ++b) next[b] = start[b];
+    for (size_t i = 0; i < N; ++i) members[next[bucket_of[i]]++] = i;
+
+    // Keys sharing a bucket and a full hash can never be separated.
+    for (size_t b = 0; b < N; ++b) {
+        for (size_t j = start[b]; j < start[b + 1]; ++j) {
+            for (size_t k = j + 1; k < start[b + 1]; ++k) {
+                if (hashes[members[j]] != hashes[members[k]]) continue;
+                if (items[members[j]].first == items[members[k]].first) {
+                    throw std::invalid_argument("make_static_map: duplicate key");
+                }
+                throw std::invalid_argument("make_static_map: two keys have the same hash");
+            }
+        }
+    }
+
+    std::array<bool, N> taken{};
+    std::array<size_t, N> trial{};
+    for (size_t size = largest; size >= 2; --size) {
+        for (size_t b = 0; b < N; ++b) {
+            if (start[b + 1] - start[b] != size) continue;
+            for (uint64_t seed = 1;; ++seed) {
+                size_t placed = 0;
+                for (; placed < size; ++placed) {
+                    size_t s = reduce(detail::static_mix(hashes[members[start[b] + placed]], seed));
+                    bool clash = taken[s];
+                    for (size_t q = 0; q < placed && !clash; ++q) clash = trial[q] == s;
+                    if (clash) break;
+                    trial[placed] = s;
+                }
+                if (placed < size) continue;
+                for (size_t q = 0; q < size; ++q) {
+                    taken[trial[q]] = true;
+                    layout.item_at[trial[q]] = members[start[b] + q];
+                }
+                layout.displacement[b] = static_cast<int64_t>(seed);
+                break;
+            }
+        }
+    }
+
+    size_t next_free = 0;
+    for (size_t b = 0; b < N; ++b) {
+        if (start[b + 1] - start[b] != 1) continue;
+        while (taken[next_free]) ++next_free;
+        taken[next_free] = true;
+        layout.item_at[next_free] = members[start[b]];
+        layout.displacement[b] = -static_cast<int64_t>(next_free) - 1;
+    }
+    return layout;
+}
+
+//******************************************************************************
+//* @brief Returns the only slot that can hold a key with the given hash.    *
+//* Both candidates are computed so that the choice between them is a     *
+//* conditional move: whether a key's bucket was a single is as good as *
+//* random, and a branch on it would mispredict half the time.          *
+//******************************************************************************
+template<typename Key, typename T, size_t N, typename Hash>
+constexpr typename StaticUnorderedMap<Key, T, N, Hash>::size_type StaticUnorderedMap<Key, T, N, Hash>::slot_for(uint64_t hash) const {
+    int64_t d = displacement_[reduce(detail::static_mix(hash, 0))];
+    size_type seeded = reduce(detail::static_mix(hash, static_cast<uint64_t>(d)));
+    size_type direct = static_cast<size_type>(-(d + 1));
+    return d < 0 ? direct : seeded;
+}
+
+//******************************************************************************
+//* @brief Builds a StaticUnorderedMap from a list of key-value pairs.       *
+//* *
+//* @param items The key-value pairs; keys must be distinct.                *
+//* @param hash  The hash function.                                          *
+//* @return The map.                                                         *
+//******************************************************************************
+template<typename Key, typename T, size_t N, typename Hash>
+constexpr StaticUnorderedMap<Key, T, N, Hash> make_static_map(const std::pair<Key, T> (&items)[N], const Hash& hash) {
+    return StaticUnorderedMap<Key, T, N, Hash>(items, hash);
+}
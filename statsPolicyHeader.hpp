@@ -0,0 +1,92 @@
+#ifndef STATS_POLICY_HPP
+#define STATS_POLICY_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Memory held by a map, as reported by UnorderedMap::memory_usage().
+struct MemoryUsage {
+    // Estimated bookkeeping a general-purpose allocator adds to every block
+    // it hands out; pool and arena allocators add less.
+    static constexpr size_t ALLOCATION_OVERHEAD = 16;
+
+    // The map object, bucket or slot arrays and bitmaps.
+    size_t table = 0;
+    // Separately allocated elements, list links included.
+    size_t nodes = 0;
+    // Number of live allocations.
+    size_t allocations = 0;
+
+    size_t overhead() const;
+    size_t total() const;
+};
+
+// Snapshot returned by UnorderedMap::stats(). A probe is one chain node
+// visited with chained storage, or one control group loaded with flat
+// storage.
+struct MapStats {
+    static constexpr size_t HISTOGRAM_SIZE = 16;
+
+    // Counted since construction or the last reset_stats().
+    size_t lookups = 0;
+    size_t hits = 0;
+    size_t probes = 0;
+    size_t max_lookup_probes = 0;
+    size_t rehashes = 0;
+    uint64_t rehash_nanoseconds = 0;
+
+    // Measured over the current contents.
+    size_t size = 0;
+    size_t bucket_count = 0;
+    size_t bytes_allocated = 0;
+    size_t max_probe_length = 0;
+    double avg_probe_length = 0;
+    // Entry i counts the elements found after i + 1 probes; the last entry
+    // also takes every longer probe sequence.
+    std::array<size_t, HISTOGRAM_SIZE> probe_histogram{};
+
+    size_t misses() const;
+    double hit_ratio() const;
+    double avg_lookup_probes() const;
+    void dump(std::ostream& os) const;
+};
+
+// Statistics policies, the ninth template parameter of UnorderedMap. With
+// NoStats, the default, every hook is compiled out and stats() does not
+// compile.
+struct NoStats {
+    static constexpr bool enabled = false;
+};
+
+// Counts lookups, probes and rehashes. The counters are relaxed atomics, so
+// concurrent const lookups, e.g. under the shared locks of
+// ConcurrentUnorderedMap, stay race-free. They belong to the map object:
+// copies and moved-to maps start from zero.
+class CollectStats {
+public:
+    static constexpr bool enabled = true;
+
+    CollectStats() = default;
+    CollectStats(const CollectStats&) {}
+    CollectStats& operator=(const CollectStats&) { return *this; }
+
+    void record_lookup(bool hit, size_t probes) const;
+    void record_rehash(uint64_t nanoseconds);
+    void fill(MapStats& out) const;
+    void reset();
+
+private:
+    mutable std::atomic<size_t> lookups_{0};
+    mutable std::atomic<size_t> hits_{0};
+    mutable std::atomic<size_t> probes_{0};
+    mutable std::atomic<size_t> max_probes_{0};
+    std::atomic<size_t> rehashes_{0};
+    std::atomic<uint64_t> rehash_nanoseconds_{0};
+};
+
+#include "statsPolicyImplementation.tpp"
+
+#endif
@@ -0,0 +1,108 @@
+#include "statsPolicyHeader.hpp"
+
+#include <iomanip>
+#include <string>
+
+//******************************************************************************
+//* @brief Returns the estimated allocator bookkeeping in bytes.             *
+//******************************************************************************
+inline size_t MemoryUsage::overhead() const {
+    return allocations * ALLOCATION_OVERHEAD;
+}
+
+//******************************************************************************
+//* @brief Returns the total footprint in bytes, overhead included.         *
+//******************************************************************************
+inline size_t MemoryUsage::total() const {
+    return table + nodes + overhead();
+}
+
+//******************************************************************************
+//* @brief Returns the number of lookups that found nothing.                 *
+//******************************************************************************
+inline size_t MapStats::misses() const {
+    return lookups - hits;
+}
+
+//******************************************************************************
+//* @brief Returns the fraction of lookups that found their key, or 0 if    *
+//* there were none.                                                    *
+//******************************************************************************
+inline double MapStats::hit_ratio() const {
+    return lookups ? double(hits) / double(lookups) : 0.0;
+}
+
+//******************************************************************************
+//* @brief Returns the average number of probes per counted lookup.         *
+//******************************************************************************
+inline double MapStats::avg_lookup_probes() const {
+    return lookups ? double(probes) / double(lookups) : 0.0;
+}
+
+//******************************************************************************
+//* @brief Writes a readable summary and the probe length histogram, one bar *
+//* per length scaled to the most common one.                          *
+//* *
+//* @param os The stream to write to.                                         *
+//******************************************************************************
+inline void MapStats::dump(std::ostream& os) const {
+    constexpr size_t BAR_WIDTH = 50;
+    os << "size " << size << ", buckets " << bucket_count << ", bytes " << bytes_allocated << '\n'
+       << "lookups " << lookups << " (hit ratio " << hit_ratio() << "), probes/lookup "
+       << avg_lookup_probes() << ", max " << max_lookup_probes << '\n'
+       << "rehashes " << rehashes << " in " << rehash_nanoseconds / 1000 << " us\n"
+       << "probe length avg " << avg_probe_length << ", max " << max_probe_length << '\n';
+    size_t peak = 0;
+    for (size_t count : probe_histogram) peak = count > peak ? count : peak;
+    for (size_t i = 0; i < HISTOGRAM_SIZE; ++i) {
+        size_t bar = peak ? (probe_histogram[i] * BAR_WIDTH + peak - 1) / peak : 0;
+        os << std::setw(3) << i + 1 << (i + 1 == HISTOGRAM_SIZE ? "+ " : "  ")
+           << std::setw(10) << probe_histogram[i] << ' ' << std::string(bar, '#') << '\n';
+    }
+}
+
+//******************************************************************************
+//* @brief Counts one lookup.                                                *
+//* *
+//* @param hit    Whether the key was found.                                 *
+//* @param probes The number of probes the lookup took.                     *
+//******************************************************************************
+inline void CollectStats::record_lookup(bool hit, size_t probes) const {
+    lookups_.fetch_add(1, std::memory_order_relaxed);
+    if (hit) hits_.fetch_add(1, std::memory_order_relaxed);
+    probes_.fetch_add(probes, std::memory_order_relaxed);
+    size_t max = max_probes_.load(std::memory_order_relaxed);
+    while (probes > max && !max_probes_.compare_exchange_weak(max, probes, std::memory_order_relaxed)) {}
+}
+
+//******************************************************************************
+//* @brief Counts one rehash and the time it took.                          *
+//******************************************************************************
+inline void CollectStats::record_rehash(uint64_t nanoseconds) {
+    rehashes_.fetch_add(1, std::memory_order_relaxed);
+    rehash_nanoseconds_.fetch_add(nanoseconds, std::memory_order_relaxed);
+}
+
+//******************************************************************************
+//* @brief Copies the counters into a snapshot.                             *
+//******************************************************************************
+inline void CollectStats::fill(MapStats& out) const {
+    out.lookups = lookups_.load(std::memory_order_relaxed);
+    out.hits = hits_.load(std::memory_order_relaxed);
+    out.probes = probes_.load(std::memory_order_relaxed);
+    out.max_lookup_probes = max_probes_.load(std::memory_order_relaxed);
+    out.rehashes = rehashes_.load(std::memory_order_relaxed);
+    out.rehash_nanoseconds = rehash_nanoseconds_.load(std::memory_order_relaxed);
+}
+
+//******************************************************************************
+//* @brief Sets every counter back to zero.                                  *
+//******************************************************************************
+inline void CollectStats::reset() {
+    lookups_.store(0, std::memory_order_relaxed);
+    hits_.store(0, std::memory_order_relaxed);
+    probes_.store(0, std::memory_order_relaxed);
+    max_probes_.store(0, std::memory_order_relaxed);
+    rehashes_.store(0, std::memory_order_relaxed);
+    rehash_nanoseconds_.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,106 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Fixed set of worker threads for UnorderedMap's parallel operations. Any
+// type with the same two members can stand in for it as an executor:
+//   concurrency()   - the number of tasks that may run at once
+//   run(n, task)    - calls task(0) ... task(n - 1), possibly in parallel,
+//                     and returns once all have finished
+// The calling thread works on the batch too, so a pool of one thread
+// spawns nothing and runs every task inline. If tasks throw, the rest
+// still run and the first exception is rethrown by run(). Batches from
+// different threads are run one at a time; a task must not call run() on
+// its own pool.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency());
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool();
+
+    size_t concurrency() const;
+    template<typename F>
+    void run(size_t tasks, F&& task);
+
+private:
+    void work();
+    void drain();
+
+    std::vector<std::thread> workers_;
+    std::mutex run_mutex_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    // The batch in progress, published under mutex_.
+    void (*invoke_)(void*, size_t) = nullptr;
+    void* task_ = nullptr;
+    size_t tasks_ = 0;
+    std::atomic<size_t> next_{0};
+    uint64_t generation_ = 0;
+    // Workers currently taking tasks from the batch.
+    size_t active_ = 0;
+    bool stop_ = false;
+    std::exception_ptr error_;
+};
+
+namespace detail {
+
+// Set by the storage engines that implement the parallel rehash() and
+// insert_parallel() overloads.
+template<typename Table, typename = void>
+struct supports_parallel : std::false_type {};
+
+template<typename Table>
+struct supports_parallel<Table, std::enable_if_t<Table::supports_parallel>> : std::true_type {};
+
+// Parallel builds construct elements, and chained tables allocate nodes,
+// from several threads at once. Only std::allocator is known to allow
+// that; maps with other allocators fall back to the serial code.
+template<typename Allocator>
+struct concurrent_allocator : std::false_type {};
+
+template<typename T>
+struct concurrent_allocator<std::allocator<T>> : std::true_type {};
+
+size_t region_length(size_t size, size_t wanted, size_t min_length, size_t align);
+
+// Groups items 0 .. n-1 by the region of the table they belong in, so that
+// one task per region can fill it with no locks. The items are split into
+// one chunk per region and each chunk is counting-sorted in parallel;
+// for_each() then visits a region's items chunk by chunk, which keeps them
+// in input order.
+class RegionPartition {
+public:
+    template<typename Executor, typename RegionOf>
+    RegionPartition(Executor& executor, size_t n, size_t regions, const RegionOf& region_of);
+
+    size_t regions() const { return regions_; }
+    size_t size(size_t region) const;
+    template<typename F>
+    void for_each(size_t region, F&& f) const;
+
+private:
+    size_t n_;
+    size_t regions_;
+    std::vector<size_t> order_;
+    // (regions_ + 1) offsets into order_ per chunk.
+    std::vector<size_t> offsets_;
+};
+
+} // namespace detail
+
+#include "threadPoolImplementation.tpp"
+
+#endif
@@ -0,0 +1,175 @@
+#include "threadPoolHeader.hpp"
+
+//******************************************************************************
+//* @brief Starts the worker threads.                                        *
+//* *
+//* @param threads The number of tasks to run at once, counting the thread  *
+//* that calls run(); threads - 1 workers are started. 0 is   *
+//* treated as 1.                                              *
+//******************************************************************************
+inline ThreadPool::ThreadPool(size_t threads) {
+    for (size_t i = 1; i < threads; ++i) workers_.emplace_back([this] { work(); });
+}
+
+//******************************************************************************
+//* @brief Stops and joins the worker threads.                              *
+//******************************************************************************
+inline ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) worker.join();
+}
+
+//******************************************************************************
+//* @brief Returns the number of tasks that run at once: the workers plus  *
+//* the calling thread.                                                 *
+//******************************************************************************
+inline size_t ThreadPool::concurrency() const {
+    return workers_.size() + 1;
+}
+
+//******************************************************************************
+//* @brief Runs a batch of tasks on the workers and the calling thread.     *
+//* Tasks are handed out one index at a time, so uneven tasks balance   *
+//* themselves.                                                         *
+//* *
+//* @param tasks The number of tasks.                                        *
+//* @param task  Called with each index in [0, tasks).                       *
+//* @throws Whatever the first failing task threw, once all have finished.  *
+//******************************************************************************
+template<typename F>
+void ThreadPool::run(size_t tasks, F&& task) {
+    using Task = std::remove_reference_t<F>;
+    if (tasks == 0) return;
+    std::lock_guard<std::mutex> run_lock(run_mutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        invoke_ = [](void* t, size_t i) { (*static_cast<Task*>(t))(i); };
+        task_ = const_cast<void*>(static_cast<const void*>(std::addressof(task)));
+        tasks_ = tasks;
+        next_.store(0, std::memory_order_relaxed);
+        error_ = nullptr;
+        ++generation_;
+    }
+    wake_.notify_all();
+    drain();
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return active_ == 0; });
+    if (error_) std::rethrow_exception(error_);
+}
+
+//******************************************************************************
+//* @brief Worker loop: waits for a new batch, takes tasks from it until    *
+//* none are left, and reports back.                                    *
+//******************************************************************************
+inline void ThreadPool::work() {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+        if (stop_) return;
+        seen = generation_;
+        ++active_;
+        lock.unlock();
+        drain();
+        lock.lock();
+        if (--active_ == 0) done_.notify_all();
+    }
+}
+
+//******************************************************************************
+//* @brief Runs tasks of the current batch until all have been claimed.     *
+//* The first exception is kept for run() to rethrow.                   *
+//******************************************************************************
+inline void ThreadPool::drain() {
+    for (size_t i = next_.fetch_add(1, std::memory_order_relaxed); i < tasks_;
+         i = next_.fetch_add(1, std::memory_order_relaxed)) {
+        try {
+            invoke_(task_, i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_) error_ = std::current_exception();
+        }
+    }
+}
+
+namespace detail {
+
+//******************************************************************************
+//* @brief Chooses how long the regions of a parallel table fill are.       *
+//* *
+//* @param size       The number of buckets or slots to split.               *
+//* @param wanted     The number of regions to aim for.                      *
+//* @param min_length The shortest region worth a task of its own.          *
+//* @param align      Every region but the last is a multiple of this long.  *
+//* @return The region length; size itself when one region is all it takes.*
+//******************************************************************************
+inline size_t region_length(size_t size, size_t wanted, size_t min_length, size_t align) {
+    if (wanted < 2 || size < 2 * min_length) return size;
+    size_t length = (size + wanted - 1) / wanted;
+    if (length < min_length) length = min_length;
+    length = (length + align - 1) / align * align;
+    return length < size ? length : size;
+}
+
+//******************************************************************************
+//* @brief Sorts the items into regions. region_of(i) is called exactly   *
+//* once per item, from the task that owns its chunk, so it may also    *
+//* record per-item results; returning regions drops the item.          *
+//* *
+//* @param executor  Runs the counting and scattering passes.               *
+//* @param n         The number of items.                                    *
+//* @param regions   The number of regions.                                  *
+//* @param region_of Returns the region of item i.                         *
+//******************************************************************************
+template<typename Executor, typename RegionOf>
+RegionPartition::RegionPartition(Executor& executor, size_t n, size_t regions, const RegionOf& region_of)
+    : n_(n), regions_(regions), order_(n), offsets_(regions * (regions + 1), 0) {
+    std::vector<uint32_t> region(n);
+    auto chunk_begin = [&](size_t c) { return c * n / regions; };
+    executor.run(regions, [&](size_t c) {
+        size_t* count = offsets_.data() + c * (regions + 1);
+        for (size_t i = chunk_begin(c); i < chunk_begin(c + 1); ++i) {
+            size_t r = region_of(i);
+            region[i] = static_cast<uint32_t>(r);
+            if (r < regions) ++count[r + 1];
+        }
+    });
+    executor.run(regions, [&](size_t c) {
+        size_t* offset = offsets_.data() + c * (regions + 1);
+        offset[0] = chunk_begin(c);
+        for (size_t r = 0; r < regions; ++r) offset[r + 1] += offset[r];
+        std::vector<size_t> cursor(offset, offset + regions);
+        for (size_t i = chunk_begin(c); i < chunk_begin(c + 1); ++i) {
+            if (region[i] < regions) order_[cursor[region[i]]++] = i;
+        }
+    });
+}
+
+//******************************************************************************
+//* @brief Returns the number of items in a region.                          *
+//******************************************************************************
+inline size_t RegionPartition::size(size_t region) const {
+    size_t total = 0;
+    for (size_t c = 0; c < regions_; ++c) {
+        const size_t* offset = offsets_.data() + c * (regions_ + 1);
+        total += offset[region + 1] - offset[region];
+    }
+    return total;
+}
+
+//******************************************************************************
+//* @brief Calls f(i) on every item of a region, in increasing order of i.  *
+//******************************************************************************
+template<typename F>
+void RegionPartition::for_each(size_t region, F&& f) const {
+    for (size_t c = 0; c < regions_; ++c) {
+        const size_t* offset = offsets_.data() + c * (regions_ + 1);
+        for (size_t k = offset[region]; k < offset[region + 1]; ++k) f(order_[k]);
+    }
+}
+
+} // namespace detail
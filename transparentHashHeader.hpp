@@ -0,0 +1,51 @@
+#ifndef TRANSPARENT_HASH_HPP
+#define TRANSPARENT_HASH_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace detail {
+
+template<typename T, typename = void>
+struct is_transparent : std::false_type {};
+
+template<typename T>
+struct is_transparent<T, std::void_t<typename T::is_transparent>> : std::true_type {};
+
+// Chooses the parameter type of the lookup functions: the caller's own
+// type when hasher and key equality are both transparent, the key type
+// otherwise. A plain alias would keep K from being deduced.
+template<bool Transparent>
+struct KeyArg {
+    template<typename K, typename Key>
+    using type = Key;
+};
+
+template<>
+struct KeyArg<true> {
+    template<typename K, typename Key>
+    using type = K;
+};
+
+} // namespace detail
+
+// Transparent hash and equality for string keys. Lookups with string
+// literals, std::string_view or const char* hash the characters in place
+// instead of building a std::string first. string_hash agrees with
+// std::hash<std::string>.
+struct string_hash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view s) const noexcept { return std::hash<std::string_view>{}(s); }
+};
+
+struct string_equal {
+    using is_transparent = void;
+
+    bool operator()(std::string_view a, std::string_view b) const noexcept { return a == b; }
+};
+
+#endif
@@ -9,12 +9,76 @@
 #include <stdexcept>
 #include <utility>
 #include <iostream>
+#include <iterator>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+
+#include "chainedTableHeader.hpp"
+#include "flatTableHeader.hpp"
+#include "incrementalTableHeader.hpp"
+#include "indexPoliciesHeader.hpp"
+#include "nodeHandleHeader.hpp"
+#include "poolAllocatorHeader.hpp"
+#include "seededHashHeader.hpp"
+#include "smallTableHeader.hpp"
+#include "snapshotHeader.hpp"
+#include "statsPolicyHeader.hpp"
+#include "threadPoolHeader.hpp"
+#include "transparentHashHeader.hpp"
+
+// Keys whose hash is cheap enough to recompute on demand. Every other key
+// type has its full hash stored next to the element by default.
+template<typename Key>
+struct is_trivially_hashable
+    : std::integral_constant<bool, std::is_arithmetic<Key>::value ||
+                                   std::is_enum<Key>::value ||
+                                   std::is_pointer<Key>::value> {};
+
+namespace detail {
+
+// True when V is a pair-like element whose .first is a Key, so the key
+// can be read from it before the element is placed.
+template<typename V, typename Key, typename = void>
+struct has_key_first : std::false_type {};
+
+template<typename V, typename Key>
+struct has_key_first<V, Key, std::void_t<decltype(std::declval<const V&>().first)>>
+    : std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(std::declval<const V&>().first)>>, Key> {};
+
+// Half-open run of iterators that a range-based for loop can walk.
+template<typename It>
+class IteratorRange {
+public:
+    IteratorRange() = default;
+    IteratorRange(It first, It last) : first_(first), last_(last) {}
+
+    It begin() const { return first_; }
+    It end() const { return last_; }
+    bool empty() const { return first_ == last_; }
+
+private:
+    It first_;
+    It last_;
+};
+
+} // namespace detail
 
 template<
     typename Key,
     typename T,
     typename Hash = std::hash<Key>,
-    typename KeyEqual = std::equal_to<Key>
+    typename KeyEqual = std::equal_to<Key>,
+    typename Storage = ChainedStorage,
+    typename IndexPolicy = ModuloIndex,
+    bool StoreHash = !is_trivially_hashable<Key>::value,
+    typename Allocator = std::allocator<std::pair<const Key, T>>,
+    typename Stats = NoStats
 >
 class UnorderedMap {
 public:
@@ -24,29 +88,65 @@ public:
     using size_type = size_t;
     using hasher = Hash;
     using key_equal = KeyEqual;
+    using allocator_type = Allocator;
+    using storage_policy = Storage;
+    using index_policy = IndexPolicy;
+    using stats_policy = Stats;
+    static constexpr bool stores_hash = StoreHash;
 
     class iterator;
     class const_iterator;
+    // One slice of the map handed out by chunks().
+    using chunk = detail::IteratorRange<iterator>;
+    using const_chunk = detail::IteratorRange<const_iterator>;
+    // An element taken out by extract(), owned outside any map.
+    using node_type = detail::NodeHandle<Key, T, Allocator,
+        typename Storage::template table<value_type, IndexPolicy, StoreHash, Allocator>::node_list>;
+    using insert_return_type = detail::InsertReturn<iterator, node_type>;
+
+    // Lookup argument type: any K when Hash and KeyEqual both define
+    // is_transparent, Key otherwise.
+    template<class K>
+    using key_arg = typename detail::KeyArg<detail::is_transparent<Hash>::value &&
+                                            detail::is_transparent<KeyEqual>::value>::template type<K, Key>;
 
-    UnorderedMap(size_type bucket_count = DEFAULT_BUCKET_COUNT,
+    UnorderedMap(size_type bucket_count = 0,
                  const Hash& hash = Hash(),
-                 const KeyEqual& equal = KeyEqual());
+                 const KeyEqual& equal = KeyEqual(),
+                 const Allocator& alloc = Allocator());
+    explicit UnorderedMap(const Allocator& alloc);
+    template<class InputIt>
+    UnorderedMap(InputIt first, InputIt last,
+                 size_type bucket_count = 0,
+                 const Hash& hash = Hash(),
+                 const KeyEqual& equal = KeyEqual(),
+                 const Allocator& alloc = Allocator());
     UnorderedMap(std::initializer_list<value_type> init,
-                 size_type bucket_count = DEFAULT_BUCKET_COUNT,
+                 size_type bucket_count = 0,
                  const Hash& hash = Hash(),
-                 const KeyEqual& equal = KeyEqual());
+                 const KeyEqual& equal = KeyEqual(),
+                 const Allocator& alloc = Allocator());
     UnorderedMap(const UnorderedMap&);
+    UnorderedMap(const UnorderedMap&, const Allocator& alloc);
     UnorderedMap(UnorderedMap&&) noexcept;
     ~UnorderedMap();
 
     UnorderedMap& operator=(const UnorderedMap&);
-    UnorderedMap& operator=(UnorderedMap&&) noexcept;
+    UnorderedMap& operator=(UnorderedMap&&) noexcept(
+        std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
+        std::allocator_traits<Allocator>::is_always_equal::value);
     UnorderedMap& operator=(std::initializer_list<value_type>);
 
     iterator begin();
     iterator end();
     const_iterator begin() const;
     const_iterator end() const;
+    template<class F>
+    void for_each(F&& f);
+    template<class F>
+    void for_each(F&& f) const;
+    std::vector<chunk> chunks(size_type n);
+    std::vector<const_chunk> chunks(size_type n) const;
 
     bool empty() const;
     size_type size() const;
@@ -54,50 +154,160 @@ public:
 
     void clear();
     std::pair<iterator,bool> insert(const value_type& kv);
+    std::pair<iterator,bool> insert(value_type&& kv);
+    template<class InputIt>
+    void insert(InputIt first, InputIt last);
+    void insert(std::initializer_list<value_type> init);
+    template<class RandomIt, class Executor>
+    void build_parallel(RandomIt first, RandomIt last, Executor& executor);
     template<class... Args>
     std::pair<iterator,bool> emplace(Args&&... args);
-    size_type erase(const Key&);
+    template<class... Args>
+    std::pair<iterator,bool> try_emplace(const Key& key, Args&&... args);
+    template<class... Args>
+    std::pair<iterator,bool> try_emplace(Key&& key, Args&&... args);
+    template<class... Args>
+    std::pair<iterator,bool> try_emplace_hashed(size_type hash, const Key& key, Args&&... args);
+    template<class... Args>
+    std::pair<iterator,bool> try_emplace_hashed(size_type hash, Key&& key, Args&&... args);
+    template<class M>
+    std::pair<iterator,bool> insert_or_assign(const Key& key, M&& obj);
+    template<class M>
+    std::pair<iterator,bool> insert_or_assign(Key&& key, M&& obj);
+    template<class K = Key>
+    size_type erase(const key_arg<K>& key);
+    template<class K = Key>
+    size_type erase(const key_arg<K>& key, size_type hash);
+    iterator erase(iterator pos);
+    iterator erase(const_iterator pos);
+    iterator erase(const_iterator first, const_iterator last);
+    node_type extract(const_iterator pos);
+    template<class K = Key>
+    node_type extract(const key_arg<K>& key);
+    insert_return_type insert(node_type&& node);
+    void merge(UnorderedMap& source);
+    void merge(UnorderedMap&& source);
     void swap(UnorderedMap&) noexcept;
 
-    mapped_type& at(const Key&);
-    const mapped_type& at(const Key&) const;
+    template<class K = Key>
+    mapped_type& at(const key_arg<K>& key);
+    template<class K = Key>
+    const mapped_type& at(const key_arg<K>& key) const;
     mapped_type& operator[](const Key&);
-    size_type count(const Key&) const;
-    iterator find(const Key&);
-    const_iterator find(const Key&) const;
-    bool contains(const Key&) const;
+    mapped_type& operator[](Key&&);
+    template<class K = Key>
+    size_type count(const key_arg<K>& key) const;
+    template<class K = Key>
+    iterator find(const key_arg<K>& key);
+    template<class K = Key>
+    const_iterator find(const key_arg<K>& key) const;
+    template<class K = Key>
+    iterator find(const key_arg<K>& key, size_type hash);
+    template<class K = Key>
+    const_iterator find(const key_arg<K>& key, size_type hash) const;
+    template<class K = Key>
+    bool contains(const key_arg<K>& key) const;
+    template<class K = Key>
+    bool contains(const key_arg<K>& key, size_type hash) const;
+    template<class K = Key>
+    void find_batch(const key_arg<K>* keys, size_type n, iterator* out);
+    template<class K = Key>
+    void find_batch(const key_arg<K>* keys, size_type n, const_iterator* out) const;
+    template<class K = Key>
+    void contains_batch(const key_arg<K>* keys, size_type n, bool* out) const;
 
     size_type bucket_count() const;
     float load_factor() const;
     float max_load_factor() const;
     void max_load_factor(float);
+    float min_load_factor() const;
+    void min_load_factor(float);
     void rehash(size_type new_count);
+    template<class Executor>
+    void rehash(size_type new_count, Executor& executor);
+    void reserve(size_type count);
+    void shrink_to_fit();
     size_type bucket_size(size_type) const;
     size_type bucket(const Key&) const;
 
     hasher hash_function() const;
+    template<class K = Key>
+    size_type hash_of(const key_arg<K>& key) const;
     key_equal key_eq() const;
+    allocator_type get_allocator() const;
+
+    MemoryUsage memory_usage() const;
+    MapStats stats() const;
+    void reset_stats();
+
+    void save(std::ostream& out) const;
+    void load(std::istream& in);
 
 private:
+    using table_type = typename Storage::template table<value_type, IndexPolicy, StoreHash, Allocator>;
+    using alloc_traits = std::allocator_traits<Allocator>;
+    using node_list = typename table_type::node_list;
+
+    // Buckets allocated by the first insertion into a map constructed with
+    // none, which is how default-constructed maps start.
     static constexpr size_type DEFAULT_BUCKET_COUNT = 16;
-    std::vector<std::list<value_type>> buckets_;
+    // Whether build_parallel() and rehash(n, executor) really run in
+    // parallel; otherwise they fall back to the serial code.
+    static constexpr bool PARALLEL = detail::supports_parallel<table_type>::value &&
+                                     detail::concurrent_allocator<Allocator>::value;
+    // Fewest elements build_parallel() hands to the executor.
+    static constexpr size_type PARALLEL_BUILD_MIN = size_type(1) << 14;
+    // Maps whose hasher can draw a new seed (SeededHash) reseed themselves
+    // when an insertion probes more than RESEED_PROBE_LIMIT nodes or groups.
+    static constexpr bool HARDENED = detail::is_reseedable<Hash>::value;
+    static constexpr size_type RESEED_PROBE_LIMIT = 32;
+    table_type table_;
     size_type num_elements_;
     float max_load_factor_;
+    // Load factor below which erase() shrinks the table; 0 disables it.
+    float min_load_factor_;
     Hash hasher_;
     KeyEqual equal_;
+    Stats stats_;
+    detail::ReseedBudget<HARDENED> reseed_;
 
     void rehash_if_needed();
+    template<class... Executor>
+    void rehash_impl(size_type new_count, Executor&... executor);
+    template<class... Executor>
+    void reserve_impl(size_type count, Executor&... executor);
+    void shrink_if_needed();
+    template<class... Args>
+    std::pair<iterator,bool> emplace_key(const Key& key, Args&&... args);
+    template<class... Args>
+    std::pair<iterator,bool> emplace_hashed(const Key& key, size_type hash, Args&&... args);
+    size_type reseed_if_flooded(const Key& key, size_type hash, size_type probes);
+    template<class K>
+    size_type own_hash(const key_arg<K>& key, size_type hash) const;
+    template<class K>
+    iterator find_hashed(const key_arg<K>& key, size_type hash);
+    template<class K>
+    const_iterator find_hashed(const key_arg<K>& key, size_type hash) const;
+    template<class K>
+    size_type erase_hashed(const key_arg<K>& key, size_type hash);
+    template<class K, class Resolve>
+    void probe_batch(const key_arg<K>* keys, size_type n, Resolve&& resolve) const;
+    template<class K>
+    void record_lookup(const key_arg<K>& key, size_type hash, bool hit) const;
+    iterator erase_at(typename table_type::position pos);
 };
 
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-class UnorderedMap<Key,T,Hash,KeyEqual>::iterator {
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+class UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator {
 public:
     using iterator_category = std::forward_iterator_tag;
     using value_type = std::pair<const Key, T>;
+    using difference_type = std::ptrdiff_t;
     using reference = value_type&;
     using pointer = value_type*;
 
-    iterator(UnorderedMap* map, size_type bucket, typename std::list<value_type>::iterator it);
+    iterator() : map_(nullptr), pos_() {}
+    iterator(UnorderedMap* map, typename table_type::position pos);
     iterator& operator++();
     iterator operator++(int);
     reference operator*() const;
@@ -106,41 +316,74 @@ public:
     bool operator!=(const iterator& other) const;
 
 private:
+    friend class UnorderedMap;
+    friend class const_iterator;
+
     UnorderedMap* map_;
-    size_type bucket_index_;
-    typename std::list<value_type>::iterator list_it_;
+    typename table_type::position pos_;
 
     void advance();
 };
 
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-class UnorderedMap<Key,T,Hash,KeyEqual>::const_iterator {
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+class UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::const_iterator {
 public:
     using map_value_type = UnorderedMap::value_type;      
+    using value_type     = map_value_type;
+    using difference_type = std::ptrdiff_t;
     using reference      = const map_value_type&;
     using pointer        = const map_value_type*;
     using iterator_category = std::forward_iterator_tag;
 
+    const_iterator() : map_(nullptr), pos_() {}
     const_iterator(const UnorderedMap* map,
-                   size_type bucket,
-                   typename std::list<map_value_type>::const_iterator it);
+                   typename table_type::const_position pos);
+    const_iterator(const iterator& it);
 
     const_iterator& operator++();
     const_iterator  operator++(int);
-    reference       operator*()  const { return *list_it_; }
-    pointer         operator->() const { return &*list_it_; }
+    reference       operator*()  const { return map_->table_.value(pos_); }
+    pointer         operator->() const { return &map_->table_.value(pos_); }
     bool            operator==(const const_iterator& o) const
-                      { return map_==o.map_ && bucket_index_==o.bucket_index_ && (bucket_index_==map_->buckets_.size() || list_it_==o.list_it_); }
+                      { return map_==o.map_ && pos_==o.pos_; }
     bool            operator!=(const const_iterator& o) const { return !(*this==o); }
 
 private:
+    friend class UnorderedMap;
+
     const UnorderedMap*                      map_;
-    size_type                                bucket_index_;
-    typename std::list<map_value_type>::const_iterator list_it_;
+    typename table_type::const_position      pos_;
 
     void advance();
 };
 
+// Erases every element for which pred returns true, in one pass over the
+// map, and returns how many were erased.
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats, class Pred>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::size_type
+erase_if(UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>& map, Pred pred);
+
+#if __has_include(<memory_resource>)
+namespace pmr {
+
+// UnorderedMap whose buckets and nodes come from a std::pmr::memory_resource,
+// e.g. a request-scoped std::pmr::monotonic_buffer_resource that is released
+// in one shot.
+template<
+    typename Key,
+    typename T,
+    typename Hash = std::hash<Key>,
+    typename KeyEqual = std::equal_to<Key>,
+    typename Storage = ChainedStorage,
+    typename IndexPolicy = ModuloIndex,
+    bool StoreHash = !is_trivially_hashable<Key>::value
+>
+using UnorderedMap = ::UnorderedMap<Key, T, Hash, KeyEqual, Storage, IndexPolicy, StoreHash,
+                                    std::pmr::polymorphic_allocator<std::pair<const Key, T>>>;
+
+} // namespace pmr
+#endif
+
 #include "unorderedMapImplementation.tpp"
 
 #endif
\ No newline at end of file
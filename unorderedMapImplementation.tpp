@@ -4,14 +4,29 @@
 //* @brief Constructs an empty UnorderedMap with a specified initial number   *
 //* of buckets, a hash function, and a key equality predicate.        *
 //* *
-//* @param bucket_count The initial number of buckets to allocate.           *
+//* @param bucket_count The initial number of buckets to allocate, rounded  *
+//* up to a count the index policy accepts. The default of *
+//* 0 allocates nothing until the first insertion.         *
 //* @param hash         The hash function object to use for key hashing.      *
 //* @param equal        The key equality predicate object to use for comparing*
 //* keys.                                                *
+//* @param alloc        The allocator for buckets, nodes and slots.          *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::UnorderedMap(size_type bucket_count, const Hash& hash, const KeyEqual& equal, const Allocator& alloc)
+    : table_(IndexPolicy::bucket_count_for(bucket_count), alloc), num_elements_(0), max_load_factor_(table_type::default_max_load_factor),
+      min_load_factor_(0.0f),
+      hasher_(hash), equal_(equal) {}
+
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-UnorderedMap<Key,T,Hash,KeyEqual>::UnorderedMap(size_type bucket_count, const Hash& hash, const KeyEqual& equal)
-    : buckets_(bucket_count), num_elements_(0), max_load_factor_(1.0f), hasher_(hash), equal_(equal) {}
+//* @brief Constructs an empty UnorderedMap that allocates through the given *
+//* allocator, from the first insertion on.                             *
+//* *
+//* @param alloc The allocator for buckets, nodes and slots.                 *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::UnorderedMap(const Allocator& alloc)
+    : UnorderedMap(0, Hash(), KeyEqual(), alloc) {}
 
 //******************************************************************************
 //* @brief Constructs an UnorderedMap with elements from an initializer list, *
@@ -24,31 +39,65 @@ UnorderedMap<Key,T,Hash,KeyEqual>::UnorderedMap(size_type bucket_count, const Ha
 //* @param hash         The hash function object to use for key hashing.      *
 //* @param equal        The key equality predicate object to use for comparing*
 //* keys.                                                *
+//* @param alloc        The allocator for buckets, nodes and slots.          *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-UnorderedMap<Key,T,Hash,KeyEqual>::UnorderedMap(std::initializer_list<value_type> init,
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::UnorderedMap(std::initializer_list<value_type> init,
+                                                  size_type bucket_count,
+                                                  const Hash& hash,
+                                                  const KeyEqual& equal,
+                                                  const Allocator& alloc)
+    : UnorderedMap(bucket_count, hash, equal, alloc) {
+    insert(init.begin(), init.end());
+}
+
+//******************************************************************************
+//* @brief Constructs an UnorderedMap from the elements of a range. The      *
+//* table is sized once up front when the length of the range is known. *
+//* *
+//* @param first        Iterator to the first element of the range.          *
+//* @param last         Iterator past the last element of the range.         *
+//* @param bucket_count The initial number of buckets.                       *
+//* @param hash         The hash function object to use.                     *
+//* @param equal        The key equality predicate object to use.            *
+//* @param alloc        The allocator for buckets, nodes and slots.          *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class InputIt>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::UnorderedMap(InputIt first, InputIt last,
                                                   size_type bucket_count,
                                                   const Hash& hash,
-                                                  const KeyEqual& equal)
-    : UnorderedMap(bucket_count, hash, equal) {
-    for (auto& kv : init) insert(kv);
+                                                  const KeyEqual& equal,
+                                                  const Allocator& alloc)
+    : UnorderedMap(bucket_count, hash, equal, alloc) {
+    insert(first, last);
 }
 
 //******************************************************************************
 //* @brief Copy constructor. Constructs a new UnorderedMap as a copy of       *
-//* another UnorderedMap.                                             *
+//* another UnorderedMap. The allocator is obtained through             *
+//* select_on_container_copy_construction().                          *
 //* *
 //* @param other The UnorderedMap to copy from.                              *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-UnorderedMap<Key,T,Hash,KeyEqual>::UnorderedMap(const UnorderedMap& other)
-    : buckets_(other.buckets_.size()), num_elements_(0), max_load_factor_(other.max_load_factor_), hasher_(other.hasher_), equal_(other.equal_) {
-    for (auto& bucket : other.buckets_) {
-        for (auto& kv : bucket) {
-            insert(kv);
-        }
-    }
-}
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::UnorderedMap(const UnorderedMap& other)
+    : UnorderedMap(other, alloc_traits::select_on_container_copy_construction(other.get_allocator())) {}
+
+//******************************************************************************
+//* @brief Copy constructor with an explicit allocator. Constructs a new      *
+//* UnorderedMap as a copy of another one, allocating through alloc.   *
+//* The storage engine clones the layout of other directly; since its  *
+//* keys are known to be unique, nothing is hashed or compared.        *
+//* *
+//* @param other The UnorderedMap to copy from.                              *
+//* @param alloc The allocator for buckets, nodes and slots.                 *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::UnorderedMap(const UnorderedMap& other, const Allocator& alloc)
+    : table_(other.table_, alloc), num_elements_(other.num_elements_), max_load_factor_(other.max_load_factor_),
+      min_load_factor_(other.min_load_factor_),
+      hasher_(other.hasher_), equal_(other.equal_) {}
 
 //******************************************************************************
 //* @brief Move constructor. Constructs a new UnorderedMap by moving the       *
@@ -57,9 +106,10 @@ UnorderedMap<Key,T,Hash,KeyEqual>::UnorderedMap(const UnorderedMap& other)
 //* @param other The UnorderedMap to move from. Its state becomes valid but   *
 //* unspecified.                                                *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-UnorderedMap<Key,T,Hash,KeyEqual>::UnorderedMap(UnorderedMap&& other) noexcept
-    : buckets_(std::move(other.buckets_)), num_elements_(other.num_elements_), max_load_factor_(other.max_load_factor_),
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::UnorderedMap(UnorderedMap&& other) noexcept
+    : table_(std::move(other.table_)), num_elements_(other.num_elements_), max_load_factor_(other.max_load_factor_),
+      min_load_factor_(other.min_load_factor_),
       hasher_(std::move(other.hasher_)), equal_(std::move(other.equal_)) {
     other.num_elements_ = 0;
 }
@@ -67,30 +117,32 @@ UnorderedMap<Key,T,Hash,KeyEqual>::UnorderedMap(UnorderedMap&& other) noexcept
 //******************************************************************************
 //* @brief Destructor. Clears the UnorderedMap and releases allocated memory. *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-UnorderedMap<Key,T,Hash,KeyEqual>::~UnorderedMap() {
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::~UnorderedMap() {
     clear();
 }
 
 //******************************************************************************
 //* @brief Copy assignment operator. Replaces the contents of this             *
-//* UnorderedMap with a copy of another UnorderedMap.                  *
+//* UnorderedMap with a copy of another UnorderedMap. The allocator is  *
+//* taken from other only if it propagates on copy assignment. The copy*
+//* is built before anything is replaced, so a throwing copy leaves     *
+//* this map unchanged.                                                *
 //* *
 //* @param other The UnorderedMap to copy from.                              *
 //* @return A reference to this UnorderedMap.                                 *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-UnorderedMap<Key,T,Hash,KeyEqual>& UnorderedMap<Key,T,Hash,KeyEqual>::operator=(const UnorderedMap& other) {
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>& UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::operator=(const UnorderedMap& other) {
     if (this != &other) {
-        clear();
+        table_type fresh(other.table_,
+                         alloc_traits::propagate_on_container_copy_assignment::value ? other.get_allocator()
+                                                                                     : get_allocator());
         hasher_ = other.hasher_; equal_ = other.equal_;
+        table_.swap(fresh);
+        num_elements_ = other.num_elements_;
         max_load_factor_ = other.max_load_factor_;
-        buckets_.assign(other.buckets_.size(), {});
-        for (auto& bucket : other.buckets_) {
-            for (auto& kv : bucket) {
-                insert(kv);
-            }
-        }
+        min_load_factor_ = other.min_load_factor_;
     }
     return *this;
 }
@@ -102,16 +154,37 @@ UnorderedMap<Key,T,Hash,KeyEqual>& UnorderedMap<Key,T,Hash,KeyEqual>::operator=(
 //* @param other The UnorderedMap to move from. Its state becomes valid but   *
 //* unspecified.                                                *
 //* @return A reference to this UnorderedMap.                                 *
-//******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-UnorderedMap<Key,T,Hash,KeyEqual>& UnorderedMap<Key,T,Hash,KeyEqual>::operator=(UnorderedMap&& other) noexcept {
-    if (this != &other) {
-        buckets_ = std::move(other.buckets_);
+//*
+//* The storage of other is taken over when the allocator propagates on
+//* move assignment or both allocators compare equal. Otherwise this map
+//* keeps its allocator and the elements are moved one by one.
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>& UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::operator=(UnorderedMap&& other) noexcept(
+    std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
+    std::allocator_traits<Allocator>::is_always_equal::value) {
+    if (this == &other) return *this;
+    if (alloc_traits::propagate_on_container_move_assignment::value ||
+        get_allocator() == other.get_allocator()) {
+        table_ = std::move(other.table_);
         num_elements_ = other.num_elements_;
         max_load_factor_ = other.max_load_factor_;
+        min_load_factor_ = other.min_load_factor_;
         hasher_ = std::move(other.hasher_);
         equal_ = std::move(other.equal_);
         other.num_elements_ = 0;
+    } else {
+        clear();
+        hasher_ = std::move(other.hasher_);
+        equal_ = std::move(other.equal_);
+        max_load_factor_ = other.max_load_factor_;
+        min_load_factor_ = other.min_load_factor_;
+        table_type fresh(other.bucket_count(), get_allocator());
+        table_.swap(fresh);
+        for (auto& kv : other) {
+            emplace(std::move(kv));
+        }
+        other.clear();
     }
     return *this;
 }
@@ -123,10 +196,10 @@ UnorderedMap<Key,T,Hash,KeyEqual>& UnorderedMap<Key,T,Hash,KeyEqual>::operator=(
 //* @param init The initializer list containing key-value pairs to insert.    *
 //* @return A reference to this UnorderedMap.                                 *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-UnorderedMap<Key,T,Hash,KeyEqual>& UnorderedMap<Key,T,Hash,KeyEqual>::operator=(std::initializer_list<value_type> init) {
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>& UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::operator=(std::initializer_list<value_type> init) {
     clear();
-    for (auto& kv : init) insert(kv);
+    insert(init.begin(), init.end());
     return *this;
 }
 
@@ -136,13 +209,9 @@ UnorderedMap<Key,T,Hash,KeyEqual>& UnorderedMap<Key,T,Hash,KeyEqual>::operator=(
 //* @return An iterator pointing to the first key-value pair in the map, or    *
 //* the end iterator if the map is empty.                             *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-typename UnorderedMap<Key,T,Hash,KeyEqual>::iterator UnorderedMap<Key,T,Hash,KeyEqual>::begin() {
-    for (size_type i = 0; i < buckets_.size(); ++i) {
-        if (!buckets_[i].empty())
-            return iterator(this, i, buckets_[i].begin());
-    }
-    return end();
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::begin() {
+    return iterator(this, table_.begin());
 }
 
 //******************************************************************************
@@ -150,9 +219,9 @@ typename UnorderedMap<Key,T,Hash,KeyEqual>::iterator UnorderedMap<Key,T,Hash,Key
 //* *
 //* @return An iterator pointing past the last key-value pair in the map.      *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-typename UnorderedMap<Key,T,Hash,KeyEqual>::iterator UnorderedMap<Key,T,Hash,KeyEqual>::end() {
-    return iterator(this, buckets_.size(), {});
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::end() {
+    return iterator(this, table_.end());
 }
 
 //******************************************************************************
@@ -161,13 +230,9 @@ typename UnorderedMap<Key,T,Hash,KeyEqual>::iterator UnorderedMap<Key,T,Hash,Key
 //* @return A const iterator pointing to the first key-value pair in the map,  *
 //* or the end const iterator if the map is empty.                    *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-typename UnorderedMap<Key,T,Hash,KeyEqual>::const_iterator UnorderedMap<Key,T,Hash,KeyEqual>::begin() const {
-    for (size_type i = 0; i < buckets_.size(); ++i) {
-        if (!buckets_[i].empty())
-            return const_iterator(this, i, buckets_[i].cbegin());
-    }
-    return end();
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::const_iterator UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::begin() const {
+    return const_iterator(this, table_.begin());
 }
 
 //******************************************************************************
@@ -175,9 +240,84 @@ typename UnorderedMap<Key,T,Hash,KeyEqual>::const_iterator UnorderedMap<Key,T,Ha
 //* *
 //* @return A const iterator pointing past the last key-value pair in the map. *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-typename UnorderedMap<Key,T,Hash,KeyEqual>::const_iterator UnorderedMap<Key,T,Hash,KeyEqual>::end() const {
-    return const_iterator(this, buckets_.size(), {});
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::const_iterator UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::end() const {
+    return const_iterator(this, table_.end());
+}
+
+//******************************************************************************
+//* @brief Calls f on every element. Unlike a loop over iterators, the       *
+//* storage engine drives the traversal itself (whole groups of control  *
+//* bytes for flat storage, occupied buckets for chaining), which keeps *
+//* the loop body small enough for the compiler to optimise as a unit.  *
+//* Elements must not be inserted or erased from within f.              *
+//* *
+//* @param f The function to call with a reference to each key-value pair.   *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class F>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::for_each(F&& f) {
+    table_.for_each(f);
+}
+
+//******************************************************************************
+//* @brief Calls f on every element (const version).                         *
+//* *
+//* @param f The function to call with a const reference to each key-value   *
+//* pair.                                                       *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class F>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::for_each(F&& f) const {
+    table_.for_each(f);
+}
+
+//******************************************************************************
+//* @brief Splits the map into n disjoint ranges that together visit every *
+//* element once, for scans spread over several threads. The cut points *
+//* are spaced evenly over the buckets (slots for flat storage), so the  *
+//* chunks hold about the same number of elements, and finding them costs*
+//* n bucket lookups rather than a walk over the map. The chunks may be  *
+//* iterated concurrently, and their elements' mapped values modified,   *
+//* as long as nothing inserts, erases or rehashes meanwhile.           *
+//* *
+//* @param n The number of chunks; 0 is treated as 1. Some chunks are empty *
+//* when n exceeds the bucket count.                                *
+//* @return n ranges, in iteration order.                                  *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+std::vector<typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::chunk>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::chunks(size_type n) {
+    if (n == 0) n = 1;
+    size_type segments = table_.segments();
+    std::vector<chunk> out;
+    out.reserve(n);
+    iterator first(this, table_.seek(0));
+    for (size_type c = 1; c <= n; ++c) {
+        iterator last = c == n ? end() : iterator(this, table_.seek(c * segments / n));
+        out.emplace_back(first, last);
+        first = last;
+    }
+    return out;
+}
+
+//******************************************************************************
+//* @brief Splits the map into n disjoint ranges (const version).           *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+std::vector<typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::const_chunk>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::chunks(size_type n) const {
+    if (n == 0) n = 1;
+    size_type segments = table_.segments();
+    std::vector<const_chunk> out;
+    out.reserve(n);
+    const_iterator first(this, table_.seek(0));
+    for (size_type c = 1; c <= n; ++c) {
+        const_iterator last = c == n ? end() : const_iterator(this, table_.seek(c * segments / n));
+        out.emplace_back(first, last);
+        first = last;
+    }
+    return out;
 }
 
 //******************************************************************************
@@ -185,8 +325,8 @@ typename UnorderedMap<Key,T,Hash,KeyEqual>::const_iterator UnorderedMap<Key,T,Ha
 //* *
 //* @return True if the map is empty, false otherwise.                         *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-bool UnorderedMap<Key,T,Hash,KeyEqual>::empty() const {
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+bool UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::empty() const {
     return num_elements_ == 0;
 }
 
@@ -196,8 +336,8 @@ bool UnorderedMap<Key,T,Hash,KeyEqual>::empty() const {
 //* *
 //* @return The number of elements in the map.                                 *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-typename UnorderedMap<Key,T,Hash,KeyEqual>::size_type UnorderedMap<Key,T,Hash,KeyEqual>::size() const {
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::size_type UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::size() const {
     return num_elements_;
 }
 
@@ -206,17 +346,17 @@ typename UnorderedMap<Key,T,Hash,KeyEqual>::size_type UnorderedMap<Key,T,Hash,Ke
 //* *
 //* @return The theoretical maximum size of the map.                           *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-typename UnorderedMap<Key,T,Hash,KeyEqual>::size_type UnorderedMap<Key,T,Hash,KeyEqual>::max_size() const {
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::size_type UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::max_size() const {
     return std::numeric_limits<size_type>::max();
 }
 
 //******************************************************************************
 //* @brief Clears the UnorderedMap, removing all elements.                     *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-void UnorderedMap<Key,T,Hash,KeyEqual>::clear() {
-    for (auto& bucket : buckets_) bucket.clear();
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::clear() {
+    table_.clear();
     num_elements_ = 0;
 }
 
@@ -229,25 +369,128 @@ void UnorderedMap<Key,T,Hash,KeyEqual>::clear() {
 //* indicating whether a new element was inserted (true) or not       *
 //* (false).                                                         *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-std::pair<typename UnorderedMap<Key,T,Hash,KeyEqual>::iterator, bool>
-UnorderedMap<Key,T,Hash,KeyEqual>::insert(const value_type& kv) {
-    rehash_if_needed();
-    size_type idx = bucket(kv.first);
-    for (auto it = buckets_[idx].begin(); it != buckets_[idx].end(); ++it) {
-        if (equal_(it->first, kv.first)) {
-            return { iterator(this, idx, it), false };
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+std::pair<typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator, bool>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::insert(const value_type& kv) {
+    return emplace_key(kv.first, kv);
+}
+
+//******************************************************************************
+//* @brief Inserts a key-value pair by moving it into the UnorderedMap. The   *
+//* pair is left untouched if the key already exists.                  *
+//* *
+//* @param kv The key-value pair to insert.                                   *
+//* @return A pair containing an iterator to the inserted or existing element *
+//* and a boolean value indicating whether the insertion took place.  *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+std::pair<typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator, bool>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::insert(value_type&& kv) {
+    return emplace_key(kv.first, std::move(kv));
+}
+
+//******************************************************************************
+//* @brief Inserts the elements of a range. For forward ranges the table is  *
+//* reserved for the whole range once, then the elements are hashed in  *
+//* batches before being placed, so the hashing loop and the probing   *
+//* loop each run without interleaving. A hardened map that reseeds    *
+//* partway through a batch hashes the rest of the batch again. Input  *
+//* ranges fall back to one insertion per element.                     *
+//* *
+//* @param first Iterator to the first element of the range.                 *
+//* @param last  Iterator past the last element of the range.                *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class InputIt>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::insert(InputIt first, InputIt last) {
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+    using element = typename std::iterator_traits<InputIt>::value_type;
+    if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value &&
+                  detail::has_key_first<element, Key>::value) {
+        reserve(num_elements_ + static_cast<size_type>(std::distance(first, last)));
+        constexpr size_type BATCH = 64;
+        size_type hashes[BATCH];
+        while (first != last) {
+            InputIt batch_end = first;
+            size_type n = 0;
+            for (; n < BATCH && batch_end != last; ++n, ++batch_end) {
+                hashes[n] = hasher_((*batch_end).first);
+            }
+            for (size_type i = 0; i < n; ++i, ++first) {
+                size_type reseeds = reseed_.spent();
+                emplace_hashed((*first).first, hashes[i], *first);
+                if (reseed_.spent() != reseeds) {
+                    InputIt rest = std::next(first);
+                    for (size_type j = i + 1; j < n; ++j, ++rest) hashes[j] = hasher_((*rest).first);
+                }
+            }
         }
+    } else {
+        for (; first != last; ++first) emplace(*first);
     }
-    buckets_[idx].push_back(kv);
-    ++num_elements_;
-    auto it = std::prev(buckets_[idx].end());
-    return { iterator(this, idx, it), true };
+}
+
+//******************************************************************************
+//* @brief Inserts the elements of a random-access range using the tasks of *
+//* an executor. The keys are hashed in parallel, the table is reserved  *
+//* for the whole range with a parallel rehash, and then the elements   *
+//* are grouped by the region of the table they belong in and every     *
+//* region is filled by one task, without locks. The few elements whose *
+//* probe crosses a region boundary are inserted serially at the end;  *
+//* a hardened map hashes those again, as it may reseed meanwhile.     *
+//* Of several elements with equal keys the first one is kept, as with   *
+//* insert(). Small ranges, storage without parallel support and maps  *
+//* with an allocator other than std::allocator use insert(first, last).*
+//* The hasher and key_equal may be called from several threads at once.*
+//* *
+//* @param first    Iterator to the first element of the range.             *
+//* @param last     Iterator past the last element of the range.            *
+//* @param executor Runs the tasks, e.g. a ThreadPool.                        *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class RandomIt, class Executor>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::build_parallel(RandomIt first, RandomIt last, Executor& executor) {
+    size_type n = static_cast<size_type>(last - first);
+    if constexpr (!PARALLEL) {
+        insert(first, last);
+    } else if (n < PARALLEL_BUILD_MIN || executor.concurrency() < 2) {
+        insert(first, last);
+    } else {
+        std::vector<size_type> hashes(n);
+        size_type chunks = 4 * executor.concurrency();
+        executor.run(chunks, [&](size_t c) {
+            for (size_type i = c * n / chunks; i < (c + 1) * n / chunks; ++i) hashes[i] = hasher_(first[i].first);
+        });
+        reserve_impl(num_elements_ + n, executor);
+        size_type inserted = 0;
+        std::vector<size_type> deferred;
+        try {
+            table_.insert_parallel(first, hashes.data(), n, equal_, executor, inserted, deferred);
+        } catch (...) {
+            num_elements_ += inserted;
+            throw;
+        }
+        num_elements_ += inserted;
+        for (size_type i : deferred) emplace_hashed(first[i].first, own_hash<Key>(first[i].first, hashes[i]), first[i]);
+    }
+}
+
+//******************************************************************************
+//* @brief Inserts the elements of an initializer list.                       *
+//* *
+//* @param init The elements to insert.                                       *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::insert(std::initializer_list<value_type> init) {
+    insert(init.begin(), init.end());
 }
 
 //******************************************************************************
 //* @brief Emplaces a new key-value pair into the UnorderedMap by constructing*
-//* the value in-place.                                                *
+//* the value in-place. When the key can be read straight from the     *
+//* arguments (a key and a mapped value, or a pair) the element is      *
+//* built directly in its node or slot; otherwise a temporary is built  *
+//* and moved in.                                                      *
 //* *
 //* @param args Arguments to forward to the constructor of the value_type.     *
 //* @return A pair containing an iterator to the emplaced element (or the      *
@@ -255,33 +498,304 @@ UnorderedMap<Key,T,Hash,KeyEqual>::insert(const value_type& kv) {
 //* indicating whether a new element was emplaced (true) or not       *
 //* (false).                                                         *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class... Args>
+std::pair<typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator, bool>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::emplace(Args&&... args) {
+    if constexpr (sizeof...(Args) == 2 &&
+                  std::is_same<std::decay_t<std::tuple_element_t<0, std::tuple<Args...>>>, Key>::value) {
+        const Key& key = std::get<0>(std::forward_as_tuple(args...));
+        return emplace_key(key, std::forward<Args>(args)...);
+    } else if constexpr (sizeof...(Args) == 1 &&
+                         std::is_same<std::decay_t<std::tuple_element_t<0, std::tuple<Args...>>>, value_type>::value) {
+        const value_type& kv = std::get<0>(std::forward_as_tuple(args...));
+        return emplace_key(kv.first, std::forward<Args>(args)...);
+    } else {
+        value_type kv(std::forward<Args>(args)...);
+        return emplace_key(kv.first, std::move(kv));
+    }
+}
+
+//******************************************************************************
+//* @brief Inserts an element constructed from key and args if the key does  *
+//* not exist yet. Nothing is constructed when it does.                 *
+//* *
+//* @param key  The key of the element.                                       *
+//* @param args Arguments forwarded to the constructor of the mapped value.    *
+//* @return A pair containing an iterator to the inserted or existing element *
+//* and a boolean value indicating whether the insertion took place.  *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
 template<class... Args>
-std::pair<typename UnorderedMap<Key,T,Hash,KeyEqual>::iterator, bool>
-UnorderedMap<Key,T,Hash,KeyEqual>::emplace(Args&&... args) {
-    value_type kv(std::forward<Args>(args)...);
-    return insert(kv);
+std::pair<typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator, bool>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::try_emplace(const Key& key, Args&&... args) {
+    return emplace_key(key, std::piecewise_construct, std::forward_as_tuple(key),
+                       std::forward_as_tuple(std::forward<Args>(args)...));
+}
+
+//******************************************************************************
+//* @brief Inserts an element constructed from key and args if the key does  *
+//* not exist yet, moving the key into the map. The key is left         *
+//* untouched when it already exists.                                   *
+//* *
+//* @param key  The key of the element.                                       *
+//* @param args Arguments forwarded to the constructor of the mapped value.    *
+//* @return A pair containing an iterator to the inserted or existing element *
+//* and a boolean value indicating whether the insertion took place.  *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class... Args>
+std::pair<typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator, bool>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::try_emplace(Key&& key, Args&&... args) {
+    return emplace_key(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                       std::forward_as_tuple(std::forward<Args>(args)...));
+}
+
+//******************************************************************************
+//* @brief Inserts an element constructed from key and args if the key does  *
+//* not exist yet, using a hash the caller has already computed.        *
+//* *
+//* @param hash The hash of key; must equal hash_of(key).                     *
+//* @param key  The key of the element.                                       *
+//* @param args Arguments forwarded to the constructor of the mapped value.    *
+//* @return A pair containing an iterator to the inserted or existing element *
+//* and a boolean value indicating whether the insertion took place.  *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class... Args>
+std::pair<typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator, bool>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::try_emplace_hashed(size_type hash, const Key& key, Args&&... args) {
+    return emplace_hashed(key, own_hash<Key>(key, hash), std::piecewise_construct, std::forward_as_tuple(key),
+                          std::forward_as_tuple(std::forward<Args>(args)...));
+}
+
+//******************************************************************************
+//* @brief Inserts an element using a precomputed hash, moving the key into *
+//* the map. The key is left untouched when it already exists.         *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class... Args>
+std::pair<typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator, bool>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::try_emplace_hashed(size_type hash, Key&& key, Args&&... args) {
+    return emplace_hashed(key, own_hash<Key>(key, hash), std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                          std::forward_as_tuple(std::forward<Args>(args)...));
+}
+
+//******************************************************************************
+//* @brief Assigns obj to the element with the given key, or inserts a new   *
+//* element if the key does not exist.                                  *
+//* *
+//* @param key The key of the element.                                        *
+//* @param obj The value to assign or insert.                                 *
+//* @return A pair containing an iterator to the element and a boolean value  *
+//* that is true if an insertion took place and false on assignment.  *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class M>
+std::pair<typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator, bool>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::insert_or_assign(const Key& key, M&& obj) {
+    auto res = try_emplace(key, std::forward<M>(obj));
+    if (!res.second) res.first->second = std::forward<M>(obj);
+    return res;
+}
+
+//******************************************************************************
+//* @brief Assigns obj to the element with the given key, or inserts a new   *
+//* element moving the key into the map.                                *
+//* *
+//* @param key The key of the element.                                        *
+//* @param obj The value to assign or insert.                                 *
+//* @return A pair containing an iterator to the element and a boolean value  *
+//* that is true if an insertion took place and false on assignment.  *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class M>
+std::pair<typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator, bool>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::insert_or_assign(Key&& key, M&& obj) {
+    auto res = try_emplace(std::move(key), std::forward<M>(obj));
+    if (!res.second) res.first->second = std::forward<M>(obj);
+    return res;
 }
 
 //******************************************************************************
 //* @brief Erases the element with the specified key from the UnorderedMap.    *
+//* With a min_load_factor() set, the erase may shrink the table, which *
+//* invalidates all iterators.                                         *
 //* *
 //* @param key The key of the element to erase.                               *
 //* @return The number of elements erased (either 0 or 1).                     *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-typename UnorderedMap<Key,T,Hash,KeyEqual>::size_type
-UnorderedMap<Key,T,Hash,KeyEqual>::erase(const Key& key) {
-    size_type idx = bucket(key);
-    auto& lst = buckets_[idx];
-    for (auto it = lst.begin(); it != lst.end(); ++it) {
-        if (equal_(it->first, key)) {
-            lst.erase(it);
-            --num_elements_;
-            return 1;
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class K>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::size_type
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::erase(const key_arg<K>& key) {
+    return erase_hashed<K>(key, hasher_(key));
+}
+
+//******************************************************************************
+//* @brief Erases the element with the specified key using a precomputed    *
+//* hash. Like erase(key), it may shrink the table.                     *
+//* *
+//* @param key  The key of the element to erase.                              *
+//* @param hash The hash of key; must equal hash_of(key).                     *
+//* @return The number of elements erased (either 0 or 1).                     *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class K>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::size_type
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::erase(const key_arg<K>& key, size_type hash) {
+    return erase_hashed<K>(key, own_hash<K>(key, hash));
+}
+
+//******************************************************************************
+//* @brief Erases the element an iterator points to. The key is not hashed *
+//* again: the iterator already holds the element's position. Unlike   *
+//* erase(key), this never shrinks the table, so the other iterators   *
+//* stay valid and a loop can keep erasing with the returned one.      *
+//* *
+//* @param pos An iterator to the element to erase; must be dereferenceable. *
+//* @return An iterator to the element that followed the erased one.        *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::erase(iterator pos) {
+    return erase_at(pos.pos_);
+}
+
+//******************************************************************************
+//* @brief Erases the element a const iterator points to. See              *
+//* erase(iterator).                                                    *
+//* *
+//* @param pos A const iterator to the element to erase.                    *
+//* @return An iterator to the element that followed the erased one.        *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::erase(const_iterator pos) {
+    return erase_at(table_.to_mutable(pos.pos_));
+}
+
+//******************************************************************************
+//* @brief Erases the elements in [first, last), walking the storage once.  *
+//* Like erase(iterator), it never shrinks the table.                   *
+//* *
+//* @param first The first element to erase.                                *
+//* @param last  The element after the last one to erase.                   *
+//* @return An iterator to last.                                            *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::erase(const_iterator first, const_iterator last) {
+    auto pos = table_.to_mutable(first.pos_);
+    auto stop = table_.to_mutable(last.pos_);
+    while (pos != stop) pos = erase_at(pos).pos_;
+    return iterator(this, stop);
+}
+
+//******************************************************************************
+//* @brief Removes the element an iterator points to and returns it in a  *
+//* node handle. With chained storage the node is unlinked as it is, so *
+//* nothing is allocated, copied or destroyed; other storage moves the  *
+//* element into a new node. Only iterators to the extracted element   *
+//* are invalidated.                                                   *
+//* *
+//* @param pos An iterator to the element; must be dereferenceable.         *
+//* @return A handle owning the element.                                    *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::node_type
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::extract(const_iterator pos) {
+    node_list nodes{typename node_list::allocator_type(get_allocator())};
+    table_.extract(table_.to_mutable(pos.pos_), nodes);
+    --num_elements_;
+    return node_type(std::move(nodes));
+}
+
+//******************************************************************************
+//* @brief Removes the element with the given key, if any, and returns it   *
+//* in a node handle.                                                   *
+//* *
+//* @param key The key of the element to extract.                           *
+//* @return A handle owning the element, or an empty handle if the key is   *
+//* not present.                                                  *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class K>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::node_type
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::extract(const key_arg<K>& key) {
+    auto pos = table_.find(key, hasher_(key), equal_);
+    if (pos == table_.end()) return node_type();
+    return extract(const_iterator(iterator(this, pos)));
+}
+
+//******************************************************************************
+//* @brief Inserts the element owned by a node handle. With chained storage *
+//* the node is linked into its bucket as it is. The handle's allocator *
+//* must compare equal to get_allocator().                             *
+//* *
+//* @param node The handle to take the element from.                        *
+//* @return The element's position, whether it was inserted, and the handle *
+//* itself if an element with the same key was already present.  *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::insert_return_type
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::insert(node_type&& node) {
+    if (node.empty()) return { end(), false, node_type() };
+    const Key& key = node.key();
+    size_type hash = hasher_(key);
+    auto pos = table_.find(key, hash, equal_);
+    if (pos != table_.end()) return { iterator(this, pos), false, std::move(node) };
+    rehash_if_needed();
+    pos = table_.insert_node(hash, *node.nodes_);
+    ++num_elements_;
+    return { iterator(this, pos), true, node_type() };
+}
+
+//******************************************************************************
+//* @brief Moves every element of source whose key is not present here    *
+//* into this map; the rest stay in source. Each key is hashed once,   *
+//* with this map's hasher. Between chained maps whose allocators      *
+//* compare equal the nodes are relinked from bucket to bucket, so the *
+//* transfer allocates nothing and never copies or moves an element;   *
+//* otherwise each element is moved into a slot or node of this map.  *
+//* *
+//* @param source The map to take the elements from.                        *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::merge(UnorderedMap& source) {
+    if (&source == this) return;
+    bool relink = get_allocator() == source.get_allocator();
+    typename node_list::allocator_type node_alloc(get_allocator());
+    auto pos = source.table_.begin();
+    while (pos != source.table_.end()) {
+        auto cur = pos;
+        source.table_.next(pos);
+        const Key& key = source.table_.value(cur).first;
+        size_type hash = hasher_(key);
+        if (table_.find(key, hash, equal_) != table_.end()) continue;
+        rehash_if_needed();
+        if (relink) {
+            node_list nodes{node_alloc};
+            source.table_.extract(cur, nodes);
+            table_.insert_node(hash, nodes);
+        } else {
+            node_list nodes{node_alloc};
+            nodes.emplace_back(hash, std::move(source.table_.value(cur)));
+            source.table_.erase(cur);
+            table_.insert_node(hash, nodes);
         }
+        --source.num_elements_;
+        ++num_elements_;
     }
-    return 0;
+}
+
+//******************************************************************************
+//* @brief Moves the elements of a temporary map into this one, as          *
+//* merge(UnorderedMap&).                                                *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::merge(UnorderedMap&& source) {
+    merge(source);
 }
 
 //******************************************************************************
@@ -290,14 +804,16 @@ UnorderedMap<Key,T,Hash,KeyEqual>::erase(const Key& key) {
 //* *
 //* @param other The other UnorderedMap to swap with.                         *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-void UnorderedMap<Key,T,Hash,KeyEqual>::swap(UnorderedMap& other) noexcept {
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::swap(UnorderedMap& other) noexcept {
     using std::swap;
-    swap(buckets_, other.buckets_);
+    table_.swap(other.table_);
     swap(num_elements_, other.num_elements_);
     swap(max_load_factor_, other.max_load_factor_);
+    swap(min_load_factor_, other.min_load_factor_);
     swap(hasher_, other.hasher_);
     swap(equal_, other.equal_);
+    swap(reseed_, other.reseed_);
 }
 
 //******************************************************************************
@@ -308,9 +824,10 @@ void UnorderedMap<Key,T,Hash,KeyEqual>::swap(UnorderedMap& other) noexcept {
 //* @return A reference to the value associated with the key.                  *
 //* @throws std::out_of_range If the key is not found in the map.              *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-T& UnorderedMap<Key,T,Hash,KeyEqual>::at(const Key& key) {
-    auto it = find(key);
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class K>
+T& UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::at(const key_arg<K>& key) {
+    auto it = find<K>(key);
     if (it == end()) throw std::out_of_range("Key not found");
     return it->second;
 }
@@ -323,9 +840,10 @@ T& UnorderedMap<Key,T,Hash,KeyEqual>::at(const Key& key) {
 //* @return A const reference to the value associated with the key.            *
 //* @throws std::out_of_range If the key is not found in the map.              *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-const T& UnorderedMap<Key,T,Hash,KeyEqual>::at(const Key& key) const {
-    auto it = find(key);
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class K>
+const T& UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::at(const key_arg<K>& key) const {
+    auto it = find<K>(key);
     if (it == end()) throw std::out_of_range("Key not found");
     return it->second;
 }
@@ -333,15 +851,26 @@ const T& UnorderedMap<Key,T,Hash,KeyEqual>::at(const Key& key) const {
 //******************************************************************************
 //* @brief Accesses or inserts the element at the specified key. If the key   *
 //* is not found, it inserts a new element with the key and a            *
-//* default-constructed value.                                         *
+//* value-initialized mapped value.                                    *
+//* *
+//* @param key The key of the element to access or insert.                    *
+//* @return A reference to the value associated with the key.                  *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+T& UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::operator[](const Key& key) {
+    return try_emplace(key).first->second;
+}
+
+//******************************************************************************
+//* @brief Accesses or inserts the element at the specified key, moving the   *
+//* key into the map if it is not found.                               *
 //* *
 //* @param key The key of the element to access or insert.                    *
 //* @return A reference to the value associated with the key.                  *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-T& UnorderedMap<Key,T,Hash,KeyEqual>::operator[](const Key& key) {
-    auto res = insert({key, T{}});
-    return res.first->second;
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+T& UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::operator[](Key&& key) {
+    return try_emplace(std::move(key)).first->second;
 }
 
 //******************************************************************************
@@ -351,29 +880,27 @@ T& UnorderedMap<Key,T,Hash,KeyEqual>::operator[](const Key& key) {
 //* @param key The key to search for.                                         *
 //* @return 1 if an element with the specified key exists, 0 otherwise.       *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-typename UnorderedMap<Key,T,Hash,KeyEqual>::size_type
-UnorderedMap<Key,T,Hash,KeyEqual>::count(const Key& key) const {
-    return contains(key) ? 1 : 0;
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class K>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::size_type
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::count(const key_arg<K>& key) const {
+    return contains<K>(key) ? 1 : 0;
 }
 
 //******************************************************************************
-//* @brief Finds the element with the specified key.                          *
+//* @brief Finds the element with the specified key. When Hash and KeyEqual *
+//* both define is_transparent, key may be of any type they accept and *
+//* is hashed and compared without being converted to Key.            *
 //* *
 //* @param key The key to search for.                                         *
 //* @return An iterator to the element with the specified key, or the end      *
 //* iterator if the key is not found.                                  *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-typename UnorderedMap<Key,T,Hash,KeyEqual>::iterator
-UnorderedMap<Key,T,Hash,KeyEqual>::find(const Key& key) {
-    size_type idx = bucket(key);
-    for (auto it = buckets_[idx].begin(); it != buckets_[idx].end(); ++it) {
-        if (equal_(it->first, key)) {
-            return iterator(this, idx, it);
-        }
-    }
-    return end();
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class K>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::find(const key_arg<K>& key) {
+    return find_hashed<K>(key, hasher_(key));
 }
 
 //******************************************************************************
@@ -383,16 +910,38 @@ UnorderedMap<Key,T,Hash,KeyEqual>::find(const Key& key) {
 //* @return A const iterator to the element with the specified key, or the end*
 //* const iterator if the key is not found.                            *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-typename UnorderedMap<Key,T,Hash,KeyEqual>::const_iterator
-UnorderedMap<Key,T,Hash,KeyEqual>::find(const Key& key) const {
-    size_type idx = bucket(key);
-    for (auto it = buckets_[idx].cbegin(); it != buckets_[idx].cend(); ++it) {
-        if (equal_(it->first, key)) {
-            return const_iterator(this, idx, it);
-        }
-    }
-    return end();
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class K>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::const_iterator
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::find(const key_arg<K>& key) const {
+    return find_hashed<K>(key, hasher_(key));
+}
+
+//******************************************************************************
+//* @brief Finds the element with the specified key using a hash the caller *
+//* has already computed, e.g. to pick a shard or probe a filter. The  *
+//* key is not hashed again.                                            *
+//* *
+//* @param key  The key to search for.                                         *
+//* @param hash The hash of key; must equal hash_of(key).                     *
+//* @return An iterator to the element, or end() if the key is not found.   *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class K>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::find(const key_arg<K>& key, size_type hash) {
+    return find_hashed<K>(key, own_hash<K>(key, hash));
+}
+
+//******************************************************************************
+//* @brief Finds the element with the specified key using a precomputed     *
+//* hash (const version).                                               *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class K>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::const_iterator
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::find(const key_arg<K>& key, size_type hash) const {
+    return find_hashed<K>(key, own_hash<K>(key, hash));
 }
 
 //******************************************************************************
@@ -402,9 +951,73 @@ UnorderedMap<Key,T,Hash,KeyEqual>::find(const Key& key) const {
 //* @param key The key to search for.                                         *
 //* @return True if an element with the specified key exists, false otherwise.*
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-bool UnorderedMap<Key,T,Hash,KeyEqual>::contains(const Key& key) const {
-    return find(key) != end();
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class K>
+bool UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::contains(const key_arg<K>& key) const {
+    return find<K>(key) != end();
+}
+
+//******************************************************************************
+//* @brief Checks for a key using a precomputed hash.                       *
+//* *
+//* @param key  The key to search for.                                         *
+//* @param hash The hash of key; must equal hash_of(key).                     *
+//* @return True if an element with the specified key exists.               *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class K>
+bool UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::contains(const key_arg<K>& key, size_type hash) const {
+    return find<K>(key, hash) != end();
+}
+
+//******************************************************************************
+//* @brief Looks up n keys at once. All hashes of a batch are computed and   *
+//* their buckets prefetched before the first key is resolved, so the  *
+//* cache misses of different keys overlap instead of running one      *
+//* after another.                                                     *
+//* *
+//* @param keys The keys to search for.                                      *
+//* @param n    The number of keys.                                          *
+//* @param out  Receives n iterators: out[i] refers to the element for       *
+//* keys[i], or is end() if that key is absent.                  *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class K>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::find_batch(const key_arg<K>* keys, size_type n, iterator* out) {
+    probe_batch<K>(keys, n, [&](size_type i, size_type hash) {
+        auto pos = table_.find(keys[i], hash, equal_);
+        record_lookup<K>(keys[i], hash, pos != table_.end());
+        out[i] = iterator(this, pos);
+    });
+}
+
+//******************************************************************************
+//* @brief Looks up n keys at once (const version).                          *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class K>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::find_batch(const key_arg<K>* keys, size_type n, const_iterator* out) const {
+    probe_batch<K>(keys, n, [&](size_type i, size_type hash) {
+        auto pos = table_.find(keys[i], hash, equal_);
+        record_lookup<K>(keys[i], hash, pos != table_.end());
+        out[i] = const_iterator(this, pos);
+    });
+}
+
+//******************************************************************************
+//* @brief Checks n keys at once, with the same prefetching as find_batch().*
+//* *
+//* @param keys The keys to search for.                                      *
+//* @param n    The number of keys.                                          *
+//* @param out  Receives n flags: out[i] is true if keys[i] is present.       *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class K>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::contains_batch(const key_arg<K>* keys, size_type n, bool* out) const {
+    probe_batch<K>(keys, n, [&](size_type i, size_type hash) {
+        out[i] = table_.find(keys[i], hash, equal_) != table_.end();
+        record_lookup<K>(keys[i], hash, out[i]);
+    });
 }
 
 //******************************************************************************
@@ -412,20 +1025,21 @@ bool UnorderedMap<Key,T,Hash,KeyEqual>::contains(const Key& key) const {
 //* *
 //* @return The number of buckets.                                            *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-typename UnorderedMap<Key,T,Hash,KeyEqual>::size_type
-UnorderedMap<Key,T,Hash,KeyEqual>::bucket_count() const {
-    return buckets_.size();
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::size_type
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::bucket_count() const {
+    return table_.bucket_count();
 }
 
 //******************************************************************************
 //* @brief Returns the average number of elements per bucket (load factor).    *
 //* *
-//* @return The load factor of the UnorderedMap.                             *
+//* @return The load factor of the UnorderedMap, or 0 if it has no buckets. *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-float UnorderedMap<Key,T,Hash,KeyEqual>::load_factor() const {
-    return static_cast<float>(num_elements_) / buckets_.size();
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+float UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::load_factor() const {
+    size_type count = table_.bucket_count();
+    return count == 0 ? 0.0f : static_cast<float>(num_elements_) / count;
 }
 
 //******************************************************************************
@@ -433,39 +1047,107 @@ float UnorderedMap<Key,T,Hash,KeyEqual>::load_factor() const {
 //* *
 //* @return The maximum load factor.                                          *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-float UnorderedMap<Key,T,Hash,KeyEqual>::max_load_factor() const {
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+float UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::max_load_factor() const {
     return max_load_factor_;
 }
 
 //******************************************************************************
 //* @brief Sets the maximum load factor, which determines when rehashing occurs.*
 //* If the current load factor exceeds the new maximum, rehashing may occur. *
+//* A map that has never allocated stays unallocated.                   *
 //* *
 //* @param ml The new maximum load factor.                                   *
+//* @throws std::invalid_argument if ml is not a positive finite number, *
+//* which no bucket count could satisfy.                                *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-void UnorderedMap<Key,T,Hash,KeyEqual>::max_load_factor(float ml) {
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::max_load_factor(float ml) {
+    if (!(ml > 0.0f && ml <= std::numeric_limits<float>::max()))
+        throw std::invalid_argument("max_load_factor must be positive and finite");
     max_load_factor_ = ml;
-    rehash_if_needed();
+    if (bucket_count() != 0) rehash_if_needed();
+}
+
+//******************************************************************************
+//* @brief Returns the minimum load factor below which erase() shrinks the  *
+//* table, or 0 if erasing never shrinks it (the default).              *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+float UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::min_load_factor() const {
+    return min_load_factor_;
+}
+
+//******************************************************************************
+//* @brief Sets the minimum load factor. Once erasing drops the load factor *
+//* below it, the table shrinks until it is about half full by          *
+//* max_load_factor(). The minimum may be at most a quarter of          *
+//* max_load_factor(), which keeps a shrunk table clear of both         *
+//* thresholds, so alternating inserts and erases cannot make it       *
+//* resize back and forth. If max_load_factor() is lowered later, the  *
+//* minimum in effect is capped at a quarter of the new value.         *
+//* *
+//* @param ml The new minimum load factor; 0 disables shrinking.             *
+//* @throws std::invalid_argument if ml is negative, NaN, or more than a   *
+//* quarter of max_load_factor().                               *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::min_load_factor(float ml) {
+    if (!(ml >= 0.0f && ml <= max_load_factor_ / 4))
+        throw std::invalid_argument("min_load_factor must be between 0 and a quarter of max_load_factor");
+    min_load_factor_ = ml;
 }
 
 //******************************************************************************
 //* @brief Rehashes the UnorderedMap to have at least the specified number of   *
-//* buckets. All existing elements are moved to the new buckets.           *
+//* buckets. All existing elements are moved to the new buckets. The count *
+//* is doubled until the current elements fit under max_load_factor(),    *
+//* then rounded up to a count the index policy accepts.                  *
 //* *
 //* @param new_count The desired new number of buckets.                       *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-void UnorderedMap<Key,T,Hash,KeyEqual>::rehash(size_type new_count) {
-    std::vector<std::list<value_type>> new_buckets(new_count);
-    for (auto& bucket : buckets_) {
-        for (auto& kv : bucket) {
-            size_type idx = Hash(hasher_)(kv.first) % new_count;
-            new_buckets[idx].push_back(std::move(const_cast<value_type&>(kv)));
-        }
-    }
-    buckets_.swap(new_buckets);
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::rehash(size_type new_count) {
+    rehash_impl(new_count);
+}
+
+//******************************************************************************
+//* @brief Rehashes like rehash(new_count), moving the elements with the    *
+//* tasks of an executor. Chained and flat storage split the new table *
+//* into regions that tasks fill without locks; other storage, maps    *
+//* with an allocator other than std::allocator, and small tables       *
+//* rehash serially. The hasher may be called from several threads at  *
+//* once.                                                               *
+//* *
+//* @param new_count The desired new number of buckets.                       *
+//* @param executor  Runs the tasks, e.g. a ThreadPool.                       *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class Executor>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::rehash(size_type new_count, Executor& executor) {
+    rehash_impl(new_count, executor);
+}
+
+//******************************************************************************
+//* @brief Reserves space for at least count elements, so that inserting up  *
+//* to that many elements does not trigger a rehash. Never shrinks the  *
+//* table.                                                             *
+//* *
+//* @param count The number of elements to make room for.                    *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::reserve(size_type count) {
+    reserve_impl(count);
+}
+
+//******************************************************************************
+//* @brief Releases unused capacity: rehashes to the smallest bucket count  *
+//* that holds the current elements under max_load_factor(). Also drops *
+//* the tombstones of flat storage. Invalidates all iterators.          *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::shrink_to_fit() {
+    rehash(0);
 }
 
 //******************************************************************************
@@ -474,10 +1156,10 @@ void UnorderedMap<Key,T,Hash,KeyEqual>::rehash(size_type new_count) {
 //* @param i The index of the bucket.                                         *
 //* @return The number of elements in the i-th bucket.                       *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-typename UnorderedMap<Key,T,Hash,KeyEqual>::size_type
-UnorderedMap<Key,T,Hash,KeyEqual>::bucket_size(size_type i) const {
-    return buckets_[i].size();
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::size_type
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::bucket_size(size_type i) const {
+    return table_.bucket_size(i);
 }
 
 //******************************************************************************
@@ -486,10 +1168,10 @@ UnorderedMap<Key,T,Hash,KeyEqual>::bucket_size(size_type i) const {
 //* @param key The key to get the bucket index for.                           *
 //* @return The index of the bucket where the key would be placed.          *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-typename UnorderedMap<Key,T,Hash,KeyEqual>::size_type
-UnorderedMap<Key,T,Hash,KeyEqual>::bucket(const Key& key) const {
-    return hasher_(key) % buckets_.size();
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::size_type
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::bucket(const Key& key) const {
+    return table_.index_for(hasher_(key));
 }
 
 //******************************************************************************
@@ -497,58 +1179,515 @@ UnorderedMap<Key,T,Hash,KeyEqual>::bucket(const Key& key) const {
 //* *
 //* @return The hash function object.                                         *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-typename UnorderedMap<Key,T,Hash,KeyEqual>::hasher UnorderedMap<Key,T,Hash,KeyEqual>::hash_function() const {
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::hasher UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::hash_function() const {
     return hasher_;
 }
 
+//******************************************************************************
+//* @brief Returns the hash the map computes for a key. Pass it to the      *
+//* overloads taking a precomputed hash, so a key used for several      *
+//* purposes is hashed only once. A hardened map changes its hashes    *
+//* whenever it reseeds, so those overloads hash the key again there.  *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class K>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::size_type UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::hash_of(const key_arg<K>& key) const {
+    return hasher_(key);
+}
+
 //******************************************************************************
 //* @brief Returns the key equality predicate object used by the              *
 //* UnorderedMap.                                                     *
 //* *
 //* @return The key equality predicate object.                                *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-typename UnorderedMap<Key,T,Hash,KeyEqual>::key_equal UnorderedMap<Key,T,Hash,KeyEqual>::key_eq() const {
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::key_equal UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::key_eq() const {
     return equal_;
 }
 
 //******************************************************************************
-//* @brief Checks if rehashing is needed based on the current load factor and *
-//* the maximum load factor, and performs rehashing if necessary.           *
+//* @brief Returns a copy of the allocator used by the UnorderedMap.          *
+//* *
+//* @return The allocator object.                                              *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::allocator_type UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::get_allocator() const {
+    return table_.get_allocator();
+}
+
+//******************************************************************************
+//* @brief Reports the memory the map holds: the map object and its bucket  *
+//* or slot arrays, the separately allocated nodes, and an estimate of  *
+//* the allocator's per-block bookkeeping. O(bucket_count()) for        *
+//* chained storage, O(1) for flat storage.                             *
+//* *
+//* @return The memory footprint, broken down.                              *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+MemoryUsage UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::memory_usage() const {
+    MemoryUsage usage = table_.memory_usage();
+    usage.table += sizeof(*this);
+    return usage;
+}
+
+//******************************************************************************
+//* @brief Returns the collected statistics. The lookup and rehash counters  *
+//* are read as they are; probe lengths and memory are measured over   *
+//* the current contents, which rehashes every key, so this is O(n).   *
+//* Only available with the CollectStats policy.                       *
+//* *
+//* @return A snapshot of the statistics.                                    *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+MapStats UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::stats() const {
+    static_assert(Stats::enabled, "stats() requires a statistics policy such as CollectStats");
+    MapStats out;
+    stats_.fill(out);
+    out.size = num_elements_;
+    out.bucket_count = table_.bucket_count();
+    out.bytes_allocated = memory_usage().total();
+    size_type total = 0;
+    auto measure = [&](const value_type& kv) {
+        size_type probes = table_.probe_length(kv.first, hasher_(kv.first), equal_);
+        total += probes;
+        if (probes > out.max_probe_length) out.max_probe_length = probes;
+        size_type slot = probes == 0 ? 0 : probes - 1;
+        ++out.probe_histogram[slot < MapStats::HISTOGRAM_SIZE ? slot : MapStats::HISTOGRAM_SIZE - 1];
+    };
+    table_.for_each(measure);
+    out.avg_probe_length = num_elements_ ? double(total) / double(num_elements_) : 0.0;
+    return out;
+}
+
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-void UnorderedMap<Key,T,Hash,KeyEqual>::rehash_if_needed() {
-    if (load_factor() > max_load_factor_) {
-        rehash(buckets_.size() * 2);
+//* @brief Sets the lookup and rehash counters back to zero.                 *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::reset_stats() {
+    static_assert(Stats::enabled, "reset_stats() requires a statistics policy such as CollectStats");
+    stats_.reset();
+}
+
+//******************************************************************************
+//* @brief Writes the map to a binary snapshot that load() and             *
+//* FrozenUnorderedMap read back (layout in snapshotHeader.hpp). The   *
+//* elements are grouped by snapshot bucket with a counting sort, and   *
+//* each is written with its hash for FrozenUnorderedMap to compare.    *
+//* Tables that store hashes supply them, so no key is hashed then.     *
+//* *
+//* @param out The stream to write to; open it in binary mode.               *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::save(std::ostream& out) const {
+    using key_serializer = serializer<Key>;
+    using mapped_serializer = serializer<T>;
+    struct Entry {
+        uint64_t hash;
+        const value_type* kv;
+    };
+
+    auto header = detail::make_snapshot_header(key_serializer::fixed_size, mapped_serializer::fixed_size, num_elements_);
+    size_type buckets = size_type(1) << header.bucket_bits;
+    std::vector<uint64_t> offsets(buckets + 1, 0);
+    std::vector<size_type> starts(buckets + 1, 0);
+    std::vector<Entry> entries;
+    entries.reserve(num_elements_);
+    // Engines that store hashes hand them out, so saving hashes no key.
+    auto hash_of = [this](const value_type& kv) { return hasher_(kv.first); };
+    auto count = [&](const value_type& kv, uint64_t hash) {
+        uint64_t b = detail::snapshot_bucket(hash, header.bucket_bits);
+        offsets[b + 1] += sizeof(uint64_t) + key_serializer::size(kv.first) + mapped_serializer::size(kv.second);
+        ++starts[b + 1];
+        entries.push_back({ hash, &kv });
+    };
+    table_.for_each_hashed(count, hash_of);
+    for (size_type b = 0; b < buckets; ++b) {
+        offsets[b + 1] += offsets[b];
+        starts[b + 1] += starts[b];
+    }
+    std::vector<Entry> sorted(entries.size());
+    for (const Entry& e : entries) sorted[starts[detail::snapshot_bucket(e.hash, header.bucket_bits)]++] = e;
+
+    header.records_size = offsets[buckets];
+    detail::write_raw(out, header);
+    detail::write_bytes(out, reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+    for (const Entry& e : sorted) {
+        detail::write_raw(out, e.hash);
+        key_serializer::write(out, e.kv->first);
+        mapped_serializer::write(out, e.kv->second);
+    }
+    if (!out) throw std::runtime_error("failed to write snapshot");
+}
+
+//******************************************************************************
+//* @brief Replaces the contents with a snapshot written by save(). The     *
+//* table is sized once up front when the stream can seek and holds     *
+//* all the records the header claims. Otherwise it is grown in steps  *
+//* as records arrive, so a forged element count can never reserve     *
+//* more than the stream actually backs. Every key is hashed with this *
+//* map's hasher, since a stored hash that happens to match under a    *
+//* different hash function says nothing about the rest.               *
+//* The map is left unchanged if the snapshot is rejected.              *
+//* *
+//* @param in The stream to read from; open it in binary mode.               *
+//* @throws std::runtime_error if the snapshot is malformed, truncated, or  *
+//* was written for other key or value types.                   *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::load(std::istream& in) {
+    using key_serializer = serializer<Key>;
+    using mapped_serializer = serializer<T>;
+
+    auto header = detail::read_raw<detail::SnapshotHeader>(in);
+    detail::check_snapshot_header(header, key_serializer::fixed_size, mapped_serializer::fixed_size);
+    detail::skip_bytes(in, ((uint64_t(1) << header.bucket_bits) + 1) * sizeof(uint64_t));
+    uint64_t left = detail::bytes_left(in);
+    if (left < header.records_size) throw std::runtime_error("snapshot truncated");
+
+    UnorderedMap fresh(DEFAULT_BUCKET_COUNT, hasher_, equal_, get_allocator());
+    fresh.max_load_factor_ = max_load_factor_;
+    fresh.min_load_factor_ = min_load_factor_;
+    constexpr uint64_t RESERVE_STEP = 4096;
+    uint64_t reserved = left != UINT64_MAX ? header.element_count : std::min(header.element_count, RESERVE_STEP);
+    fresh.reserve(static_cast<size_type>(reserved));
+    // Records come in snapshot-bucket order, which is unrelated to this
+    // table's layout, so they are decoded in batches whose slots are
+    // prefetched before any of them is inserted.
+    constexpr size_type BATCH = 32;
+    std::vector<std::pair<Key, T>> batch;
+    batch.reserve(BATCH);
+    size_type hashes[BATCH];
+    for (uint64_t done = 0; done < header.element_count;) {
+        if (done == reserved) {
+            reserved = std::min(header.element_count, 2 * reserved);
+            fresh.reserve(static_cast<size_type>(reserved));
+        }
+        size_type n = static_cast<size_type>(std::min<uint64_t>(BATCH, reserved - done));
+        batch.clear();
+        for (size_type i = 0; i < n; ++i) {
+            detail::read_raw<uint64_t>(in);
+            Key key = key_serializer::read(in);
+            T value = mapped_serializer::read(in);
+            hashes[i] = fresh.hasher_(key);
+            fresh.table_.prefetch(hashes[i]);
+            batch.emplace_back(std::move(key), std::move(value));
+        }
+        for (size_type i = 0; i < n; ++i) {
+            size_type reseeds = fresh.reseed_.spent();
+            fresh.emplace_hashed(batch[i].first, hashes[i], std::move(batch[i].first), std::move(batch[i].second));
+            if (fresh.reseed_.spent() != reseeds) {
+                for (size_type j = i + 1; j < n; ++j) hashes[j] = fresh.hasher_(batch[j].first);
+            }
+        }
+        done += n;
     }
+    swap(fresh);
+}
+
+//******************************************************************************
+//* @brief Shared body of both rehash() overloads; executor is empty or    *
+//* holds the executor to run the parallel rehash on.                   *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class... Executor>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::rehash_impl(size_type new_count, Executor&... executor) {
+    if (new_count == 0) new_count = 1;
+    while (num_elements_ > table_type::max_load(new_count, max_load_factor_)) new_count *= 2;
+    new_count = IndexPolicy::bucket_count_for(new_count);
+    auto start = Stats::enabled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+    auto hash_of = [this](const value_type& kv) { return hasher_(kv.first); };
+    if constexpr (PARALLEL && sizeof...(Executor) == 1) {
+        table_.rehash(new_count, hash_of, executor...);
+    } else {
+        table_.rehash(new_count, hash_of);
+    }
+    if constexpr (Stats::enabled) {
+        stats_.record_rehash(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+}
+
+//******************************************************************************
+//* @brief Shared body of reserve() and the parallel build; executor is     *
+//* passed on to rehash_impl().                                         *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class... Executor>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::reserve_impl(size_type count, Executor&... executor) {
+    if (count + table_.tombstones() <= table_type::max_load(table_.bucket_count(), max_load_factor_)) return;
+    size_type new_count = static_cast<size_type>(static_cast<double>(count) / max_load_factor_);
+    if (new_count == 0) new_count = 1;
+    while (table_type::max_load(new_count, max_load_factor_) < count) ++new_count;
+    rehash_impl(new_count < table_.bucket_count() ? table_.bucket_count() : new_count, executor...);
+}
+
+//******************************************************************************
+//* @brief Checks whether one more element fits under the maximum load factor*
+//* and rehashes if it does not. Tombstones left by the storage engine   *
+//* count as occupied; when they exhaust the limit, they are reclaimed at  *
+//* the current size instead of the table being grown. That only pays   *
+//* off while the elements leave an eighth of the limit free: closer to *
+//* it, the next few deletions would force another full pass, so the    *
+//* table grows instead. A table with no buckets yet gets               *
+//* DEFAULT_BUCKET_COUNT of them.                                       *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::rehash_if_needed() {
+    size_type count = table_.bucket_count();
+    size_type limit = table_type::max_load(count, max_load_factor_);
+    if (num_elements_ + table_.tombstones() < limit) return;
+    if (table_.tombstones() != 0 && num_elements_ < limit - limit / 8) {
+        rehash(count);
+        return;
+    }
+    if (count == 0) count = DEFAULT_BUCKET_COUNT;
+    else if (num_elements_ < limit) count *= 2;
+    while (num_elements_ >= table_type::max_load(count, max_load_factor_)) count *= 2;
+    rehash(count);
+}
+
+//******************************************************************************
+//* @brief Shrinks the table after an erase that left it emptier than       *
+//* min_load_factor() allows. The bucket count is halved while the      *
+//* elements still fit in half of max_load_factor(), never below the    *
+//* default bucket count.                                               *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::shrink_if_needed() {
+    if (min_load_factor_ <= 0.0f) return;
+    size_type count = table_.bucket_count();
+    float min_load = min_load_factor_ < max_load_factor_ / 4 ? min_load_factor_ : max_load_factor_ / 4;
+    if (count <= DEFAULT_BUCKET_COUNT || num_elements_ >= table_type::max_load(count, min_load)) return;
+    while (count / 2 >= DEFAULT_BUCKET_COUNT &&
+           num_elements_ <= table_type::max_load(count / 2, max_load_factor_ / 2)) {
+        count /= 2;
+    }
+    rehash(count);
+}
+
+//******************************************************************************
+//* @brief Common insertion path. Looks the key up once and, only if it is   *
+//* absent, grows the table and constructs the element in place from   *
+//* args. The lookup happens before any rehash, so key may refer to an  *
+//* existing element or to one of the arguments. An empty map skips    *
+//* the lookup, which also keeps a table without buckets untouched.    *
+//* *
+//* @param key  The key of the element to insert.                            *
+//* @param args Arguments forwarded to the constructor of the value_type.     *
+//* @return A pair containing an iterator to the inserted or existing element *
+//* and a boolean value indicating whether the insertion took place.  *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class... Args>
+std::pair<typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator, bool>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::emplace_key(const Key& key, Args&&... args) {
+    return emplace_hashed(key, hasher_(key), std::forward<Args>(args)...);
+}
+
+//******************************************************************************
+//* @brief Insertion path for a key whose hash is already known.             *
+//* *
+//* @param key  The key of the element to insert.                            *
+//* @param hash The hash of key, as computed by the map's hasher.           *
+//* @param args Arguments forwarded to the constructor of the value_type.     *
+//* @return A pair containing an iterator to the inserted or existing element *
+//* and a boolean value indicating whether the insertion took place.  *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class... Args>
+std::pair<typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator, bool>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::emplace_hashed(const Key& key, size_type hash, Args&&... args) {
+    if (num_elements_ != 0) {
+        if constexpr (HARDENED) {
+            size_type probes;
+            auto pos = table_.to_mutable(table_.find(key, hash, equal_, probes));
+            if (pos != table_.end()) {
+                return { iterator(this, pos), false };
+            }
+            hash = reseed_if_flooded(key, hash, probes);
+        } else {
+            auto pos = table_.find(key, hash, equal_);
+            if (pos != table_.end()) {
+                return { iterator(this, pos), false };
+            }
+        }
+    }
+    rehash_if_needed();
+    auto pos = table_.emplace(hash, std::forward<Args>(args)...);
+    ++num_elements_;
+    return { iterator(this, pos), true };
+}
+
+//******************************************************************************
+//* @brief Hardened maps only: called by an insertion whose key is absent, *
+//* with the probes its lookup took. If there were more than           *
+//* RESEED_PROBE_LIMIT, the keys are clustering, so the hasher draws a *
+//* new seed and the table is rebuilt under it. Reseeds are allowed    *
+//* once per doubling of the map, which keeps their cost amortized     *
+//* constant even for keys whose inner hashes collide outright and no *
+//* seed can separate.                                                  *
+//* *
+//* @param key    The key about to be inserted.                            *
+//* @param hash   Its hash under the current seed.                         *
+//* @param probes The probes the lookup of key took.                        *
+//* @return The hash of key to insert it with, new if the map reseeded.   *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::size_type
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::reseed_if_flooded(const Key& key, size_type hash, size_type probes) {
+    if (probes <= RESEED_PROBE_LIMIT || !reseed_.allows(num_elements_)) return hash;
+    auto start = Stats::enabled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+    Hash next = hasher_;
+    next.reseed();
+    table_.reseed([&next](const value_type& kv) { return static_cast<size_type>(next(kv.first)); });
+    hasher_ = std::move(next);
+    reseed_.spend(num_elements_);
+    if constexpr (Stats::enabled) {
+        stats_.record_rehash(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+    return hasher_(key);
+}
+
+//******************************************************************************
+//* @brief Returns the hash to look key up with, given one the caller      *
+//* computed. A hardened map may have reseeded since the caller hashed *
+//* the key, so it hashes the key again; other maps trust the caller.  *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class K>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::size_type
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::own_hash(const key_arg<K>& key, size_type hash) const {
+    if constexpr (HARDENED) {
+        (void)hash;
+        return hasher_(key);
+    } else {
+        (void)key;
+        return hash;
+    }
+}
+
+//******************************************************************************
+//* @brief Shared body of the find() overloads, given the key's hash.      *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class K>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::find_hashed(const key_arg<K>& key, size_type hash) {
+    auto pos = table_.find(key, hash, equal_);
+    record_lookup<K>(key, hash, pos != table_.end());
+    return iterator(this, pos);
+}
+
+//******************************************************************************
+//* @brief Shared body of the const find() overloads.                      *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class K>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::const_iterator
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::find_hashed(const key_arg<K>& key, size_type hash) const {
+    auto pos = table_.find(key, hash, equal_);
+    record_lookup<K>(key, hash, pos != table_.end());
+    return const_iterator(this, pos);
+}
+
+//******************************************************************************
+//* @brief Shared body of the erase() overloads taking a key.              *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class K>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::size_type
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::erase_hashed(const key_arg<K>& key, size_type hash) {
+    auto pos = table_.find(key, hash, equal_);
+    if (pos == table_.end()) return 0;
+    table_.erase(pos);
+    --num_elements_;
+    shrink_if_needed();
+    return 1;
+}
+
+//******************************************************************************
+//* @brief Passes a finished lookup to the statistics policy, with the      *
+//* number of probes it took. Compiles to nothing with NoStats.        *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class K>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::record_lookup(const key_arg<K>& key, size_type hash, bool hit) const {
+    if constexpr (Stats::enabled) {
+        stats_.record_lookup(hit, table_.probe_length(key, hash, equal_));
+    } else {
+        (void)key;
+        (void)hash;
+        (void)hit;
+    }
+}
+
+//******************************************************************************
+//* @brief Drives a batched lookup. Keys are taken BATCH at a time: the      *
+//* batch is hashed and its buckets prefetched, then the first chain   *
+//* links are prefetched, and only then is each key resolved. By the   *
+//* time resolve runs for a key its lines have had the better part of  *
+//* a batch's worth of work to arrive.                                 *
+//* *
+//* @param keys    The keys to look up.                                      *
+//* @param n       The number of keys.                                      *
+//* @param resolve Called as resolve(i, hash) for every key, in order.      *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+template<class K, class Resolve>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::probe_batch(const key_arg<K>* keys, size_type n, Resolve&& resolve) const {
+    constexpr size_type BATCH = 32;
+    size_type hashes[BATCH];
+    for (size_type base = 0; base < n; base += BATCH) {
+        size_type count = n - base < BATCH ? n - base : BATCH;
+        for (size_type i = 0; i < count; ++i) {
+            hashes[i] = hasher_(keys[base + i]);
+            table_.prefetch(hashes[i]);
+        }
+        for (size_type i = 0; i < count; ++i) table_.prefetch_chain(hashes[i]);
+        for (size_type i = 0; i < count; ++i) resolve(base + i, hashes[i]);
+    }
+}
+
+//******************************************************************************
+//* @brief Removes the element at a storage position and returns an        *
+//* iterator to the one after it. The successor is found first; erasing *
+//* an element leaves every other position valid in all engines.        *
+//* *
+//* @param pos The position of the element to erase.                        *
+//* @return An iterator to the next element, or end().                      *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::erase_at(typename table_type::position pos) {
+    auto next = pos;
+    table_.next(next);
+    table_.erase(pos);
+    --num_elements_;
+    return iterator(this, next);
 }
 
 //******************************************************************************
 //* @brief Constructs an iterator for the UnorderedMap.                       *
 //* *
 //* @param map   A pointer to the UnorderedMap this iterator belongs to.       *
-//* @param bucket The index of the current bucket the iterator is pointing to. *
-//* @param it    The iterator within the std::list of the current bucket.     *
+//* @param pos   The storage position (bucket node or slot) it points to.    *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-UnorderedMap<Key,T,Hash,KeyEqual>::iterator::iterator(UnorderedMap* map, size_type bucket, typename std::list<value_type>::iterator it)
-    : map_(map), bucket_index_(bucket), list_it_(it) {}
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator::iterator(UnorderedMap* map, typename table_type::position pos)
+    : map_(map), pos_(pos) {}
 
 //******************************************************************************
 //* @brief Advances the iterator to the next element in the UnorderedMap.      *
-//* It moves to the next element in the current bucket, or to the first      *
-//* element of the next non-empty bucket if the current bucket is exhausted.*
-//******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-void UnorderedMap<Key,T,Hash,KeyEqual>::iterator::advance() {
-    if (bucket_index_ >= map_->buckets_.size()) return;
-    ++list_it_;
-    while (bucket_index_ < map_->buckets_.size() && list_it_ == map_->buckets_[bucket_index_].end()) {
-        ++bucket_index_;
-        if (bucket_index_ < map_->buckets_.size())
-            list_it_ = map_->buckets_[bucket_index_].begin();
-    }
+//* The storage engine decides what "next" means: the next node of the      *
+//* current chain or bucket for chaining, the next occupied slot for flat  *
+//* storage.                                                             *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator::advance() {
+    map_->table_.next(pos_);
 }
 
 //******************************************************************************
@@ -557,8 +1696,8 @@ void UnorderedMap<Key,T,Hash,KeyEqual>::iterator::advance() {
 //* *
 //* @return A reference to the incremented iterator.                         *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-typename UnorderedMap<Key,T,Hash,KeyEqual>::iterator& UnorderedMap<Key,T,Hash,KeyEqual>::iterator::operator++() {
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator& UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator::operator++() {
     advance();
     return *this;
 }
@@ -569,8 +1708,8 @@ typename UnorderedMap<Key,T,Hash,KeyEqual>::iterator& UnorderedMap<Key,T,Hash,Ke
 //* *
 //* @return A copy of the iterator before the increment.                     *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-typename UnorderedMap<Key,T,Hash,KeyEqual>::iterator UnorderedMap<Key,T,Hash,KeyEqual>::iterator::operator++(int) {
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator::operator++(int) {
     iterator tmp = *this;
     advance();
     return tmp;
@@ -582,9 +1721,9 @@ typename UnorderedMap<Key,T,Hash,KeyEqual>::iterator UnorderedMap<Key,T,Hash,Key
 //* *
 //* @return A reference to the current key-value pair.                       *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-typename UnorderedMap<Key,T,Hash,KeyEqual>::iterator::reference UnorderedMap<Key,T,Hash,KeyEqual>::iterator::operator*() const {
-    return *list_it_;
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator::reference UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator::operator*() const {
+    return map_->table_.value(pos_);
 }
 
 //******************************************************************************
@@ -593,9 +1732,9 @@ typename UnorderedMap<Key,T,Hash,KeyEqual>::iterator::reference UnorderedMap<Key
 //* *
 //* @return A pointer to the current key-value pair.                         *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-typename UnorderedMap<Key,T,Hash,KeyEqual>::iterator::pointer UnorderedMap<Key,T,Hash,KeyEqual>::iterator::operator->() const {
-    return &(*list_it_);
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator::pointer UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator::operator->() const {
+    return &map_->table_.value(pos_);
 }
 
 //******************************************************************************
@@ -605,9 +1744,9 @@ typename UnorderedMap<Key,T,Hash,KeyEqual>::iterator::pointer UnorderedMap<Key,T
 //* @param other The other iterator to compare with.                         *
 //* @return True if the iterators are equal, false otherwise.                *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-bool UnorderedMap<Key,T,Hash,KeyEqual>::iterator::operator==(const iterator& other) const {
-    return map_ == other.map_ && bucket_index_ == other.bucket_index_ && (bucket_index_ == map_->buckets_.size() || list_it_ == other.list_it_);
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+bool UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator::operator==(const iterator& other) const {
+    return map_ == other.map_ && pos_ == other.pos_;
 }
 
 //******************************************************************************
@@ -617,8 +1756,8 @@ bool UnorderedMap<Key,T,Hash,KeyEqual>::iterator::operator==(const iterator& oth
 //* @param other The other iterator to compare with.                         *
 //* @return True if the iterators are not equal, false otherwise.            *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-bool UnorderedMap<Key,T,Hash,KeyEqual>::iterator::operator!=(const iterator& other) const {
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+bool UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::iterator::operator!=(const iterator& other) const {
     return !(*this == other);
 }
 
@@ -626,35 +1765,35 @@ bool UnorderedMap<Key,T,Hash,KeyEqual>::iterator::operator!=(const iterator& oth
 //* @brief Constructs a const iterator for the UnorderedMap.                   *
 //* *
 //* @param map   A pointer to the const UnorderedMap this iterator belongs to. *
-//* @param bucket The index of the current bucket the iterator is pointing to. *
-//* @param it    The const iterator within the std::list of the current bucket.*
+//* @param pos   The storage position (bucket node or slot) it points to.    *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-UnorderedMap<Key,T,Hash,KeyEqual>::const_iterator::
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::const_iterator::
 const_iterator(const UnorderedMap* map,
-               size_type bucket,
-               typename std::list<typename UnorderedMap::value_type>::const_iterator it)
+               typename table_type::const_position pos)
   : map_(map)
-  , bucket_index_(bucket)
-  , list_it_(it)
+  , pos_(pos)
+{}
+
+//******************************************************************************
+//* @brief Converts an iterator to a const iterator to the same element.     *
+//* *
+//* @param it The iterator to convert.                                      *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::const_iterator::
+const_iterator(const iterator& it)
+  : map_(it.map_)
+  , pos_(table_type::to_const(it.pos_))
 {}
 
 //******************************************************************************
 //* @brief Advances the const iterator to the next element in the             *
-//* UnorderedMap. It moves to the next element in the current bucket, or to  *
-//* the first element of the next non-empty bucket if the current bucket is  *
-//* exhausted.                                                           *
-//******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-void UnorderedMap<Key,T,Hash,KeyEqual>::const_iterator::advance() {
-    if (bucket_index_ >= map_->buckets_.size()) return;
-    ++list_it_;
-    while (bucket_index_ < map_->buckets_.size() &&
-           list_it_ == map_->buckets_[bucket_index_].cend()) {
-        ++bucket_index_;
-        if (bucket_index_ < map_->buckets_.size())
-            list_it_ = map_->buckets_[bucket_index_].cbegin();
-    }
+//* UnorderedMap, as decided by the storage engine.                       *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+void UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::const_iterator::advance() {
+    map_->table_.next(pos_);
 }
 
 //******************************************************************************
@@ -663,9 +1802,9 @@ void UnorderedMap<Key,T,Hash,KeyEqual>::const_iterator::advance() {
 //* *
 //* @return A reference to the incremented const iterator.                    *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-typename UnorderedMap<Key,T,Hash,KeyEqual>::const_iterator&
-UnorderedMap<Key,T,Hash,KeyEqual>::const_iterator::operator++() {
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::const_iterator&
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::const_iterator::operator++() {
     advance();
     return *this;
 }
@@ -676,10 +1815,32 @@ UnorderedMap<Key,T,Hash,KeyEqual>::const_iterator::operator++() {
 //* *
 //* @return A copy of the const iterator before the increment.                *
 //******************************************************************************
-template<typename Key, typename T, typename Hash, typename KeyEqual>
-typename UnorderedMap<Key,T,Hash,KeyEqual>::const_iterator
-UnorderedMap<Key,T,Hash,KeyEqual>::const_iterator::operator++(int) {
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::const_iterator
+UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::const_iterator::operator++(int) {
     const_iterator tmp = *this;
     advance();
     return tmp;
-}
\ No newline at end of file
+}
+//******************************************************************************
+//* @brief Erases every element that satisfies a predicate. Each element is  *
+//* visited once through its iterator, so nothing is hashed, looked up   *
+//* or copied aside, and the table is never shrunk during the sweep.     *
+//* *
+//* @param map  The map to filter.                                          *
+//* @param pred Returns true for the elements to erase.                     *
+//* @return The number of elements erased.                                   *
+//******************************************************************************
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Storage, typename IndexPolicy, bool StoreHash, typename Allocator, typename Stats, class Pred>
+typename UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>::size_type
+erase_if(UnorderedMap<Key,T,Hash,KeyEqual,Storage,IndexPolicy,StoreHash,Allocator,Stats>& map, Pred pred) {
+    auto old_size = map.size();
+    for (auto it = map.begin(); it != map.end();) {
+        if (pred(*it)) {
+            it = map.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return old_size - map.size();
+}